@@ -7,16 +7,59 @@
 #include "dear_nes_lib/cartridge.h"
 #include "dear_nes_lib/dma.h"
 #include "dear_nes_lib/ppu.h"
+#include "dear_nes_lib/save_state.h"
+#include "dear_nes_lib/scheduler.h"
 
 namespace dearnes {
 
 Bus::Bus() {
     m_CpuRam.fill(0x00);
+    UpdatePageTable();
 }
 
 void Bus::SetCartridge(Cartridge* cartridge) {
     assert(cartridge != nullptr);
     m_Cartridge = cartridge;
+    UpdatePageTable();
+}
+
+void Bus::SaveState(StateWriter& writer) const {
+    writer.Write(m_Controllers);
+    writer.Write(m_ControllerState);
+    writer.Write(m_CpuRam);
+}
+
+void Bus::LoadState(StateReader& reader) {
+    reader.Read(m_Controllers);
+    reader.Read(m_ControllerState);
+    reader.Read(m_CpuRam);
+    UpdatePageTable();
+}
+
+void Bus::UpdatePageTable() {
+    m_ReadPages.fill(nullptr);
+    m_WritePages.fill(nullptr);
+
+    // $0000-$1FFF: 2 KB of RAM mirrored four times
+    constexpr uint8_t ramPages = 0x2000 >> CPU_PAGE_SHIFT;
+    for (uint8_t page = 0; page < ramPages; ++page) {
+        uint8_t* ram = &m_CpuRam[(page * SIZE_CPU_PAGE) & (SIZE_CPU_RAM - 1)];
+        m_ReadPages[page] = ram;
+        m_WritePages[page] = ram;
+    }
+
+    if (m_Cartridge == nullptr) {
+        return;
+    }
+    // $4000-$43FF holds the APU and I/O registers, so the first page that can
+    // be fully owned by the cartridge starts at $4400
+    constexpr uint8_t firstCartridgePage = 0x4400 >> CPU_PAGE_SHIFT;
+    for (size_t page = firstCartridgePage; page < NUM_CPU_PAGES; ++page) {
+        m_ReadPages[page] =
+            m_Cartridge->GetCpuReadPage(static_cast<uint8_t>(page));
+        m_WritePages[page] =
+            m_Cartridge->GetCpuWritePage(static_cast<uint8_t>(page));
+    }
 }
 
 void Bus::SetDma(Dma* dma) {
@@ -29,6 +72,18 @@ void Bus::SetPpu(Ppu* ppu) {
     m_Ppu = ppu;
 }
 
+void Bus::SetSystemClock(const uint64_t* systemClockCounter) {
+    assert(systemClockCounter != nullptr);
+    m_SystemClockCounter = systemClockCounter;
+}
+
+void Bus::SetScheduler(Scheduler* scheduler) {
+    assert(scheduler != nullptr);
+    m_Scheduler = scheduler;
+}
+
+void Bus::CatchUpPpu() { m_Ppu->CatchUp(*m_SystemClockCounter); }
+
 uint8_t Bus::GetControllerState(size_t controllerIdx) const {
     return m_Controllers[controllerIdx];
 }
@@ -41,25 +96,38 @@ void Bus::WriteControllerState(size_t controllerIdx, uint8_t data) {
     m_Controllers[controllerIdx] |= data;
 }
 
-void Bus::CpuWrite(uint16_t address, uint8_t data) {
+void Bus::CpuWriteHandler(uint16_t address, uint8_t data) {
+    // Writes to the cartridge space can switch the banks the PPU reads
+    if (address >= 0x4020 || (address >= 0x2000 && address <= 0x3FFF)) {
+        CatchUpPpu();
+    }
     if (m_Cartridge && m_Cartridge->CpuWrite(address, data)) {
+        if (m_Cartridge->ConsumeMappingChanged()) {
+            UpdatePageTable();
+            m_Ppu->UpdatePageTable();
+        }
     } else if (address >= 0x0000 && address <= 0x1FFF) {
         m_CpuRam[GetRealRamAddress(address)] = data;
     } else if (address >= 0x2000 && address <= 0x3FFF) {
         m_Ppu->CpuWrite(GetRealPpuAddress(address), data);
     } else if (address == 0x4014) {
         m_Dma->StartTransfer(data);
+        // The instructions run with the counter on their next tick, where
+        // the transfer starts
+        m_Scheduler->Schedule(ScheduledEvent::DMA_TRANSFER,
+                              *m_SystemClockCounter);
     } else if (address >= 0x4016 && address <= 0x4017) {
         m_ControllerState[address & 0x0001] = m_Controllers[address & 0x0001];
     }
 }
 
-uint8_t Bus::CpuRead(uint16_t address, bool isReadOnly) {
+uint8_t Bus::CpuReadHandler(uint16_t address, bool isReadOnly) {
     uint8_t data = 0x00;
     if (m_Cartridge && m_Cartridge->CpuRead(address, data)) {
     } else if (address >= 0x0000 && address <= 0x1FFF) {
         data = m_CpuRam[GetRealRamAddress(address)];
     } else if (address >= 0x2000 && address <= 0x3FFF) {
+        CatchUpPpu();
         data = m_Ppu->CpuRead(GetRealPpuAddress(address), isReadOnly);
     } else if (address >= 0x4016 && address <= 0x4017) {
         data = (m_ControllerState[address & 0x0001] & 0x80) > 0;
@@ -1,26 +1,39 @@
 // Copyright (c) 2020 Emmanuel Arias
 #include "dear_nes_lib/cartridge.h"
-#include "dear_nes_lib/mapper.h"
 
-namespace dearnes {
+#include <cstring>
+#include <utility>
+#include <variant>
+
+#include "dear_nes_lib/enums.h"
+#include "dear_nes_lib/save_state.h"
 
-Cartridge::Cartridge(CartridgeHeader&& header, IMapper* mapper,
-                     std::vector<uint8_t>&& programMemory,
-                     std::vector<uint8_t>&& characterMemory)
-    : m_CartridgeHeader{header},
-      m_Mapper{mapper},
-      m_ProgramMemory{programMemory},
-      m_CharacterMemory{characterMemory} {}
+namespace dearnes {
 
-Cartridge::~Cartridge() { delete m_Mapper; }
+Cartridge::Cartridge(std::shared_ptr<const RomImage> romImage,
+                     MapperVariant mapper)
+    : m_RomImage{std::move(romImage)},
+      m_Mapper{std::move(mapper)},
+      m_ProgramMemory{m_RomImage->GetProgramMemory()},
+      m_CharacterMemory{m_RomImage->GetCharacterMemory()},
+      m_CharacterMemorySize{m_RomImage->GetCharacterMemorySize()} {
+    if (m_CharacterMemorySize == 0) {
+        m_CharacterMemoryCopy.resize(SIZE_CHR_RAM);
+        m_CharacterMemory = m_CharacterMemoryCopy.data();
+        m_CharacterMemorySize = m_CharacterMemoryCopy.size();
+    }
+}
 
 CartridgeHeader::MIRRORING_MODE Cartridge::GetMirroringMode() const {
-    return m_CartridgeHeader.GetMirroringMode();
+    return m_RomImage->GetHeader().GetMirroringMode();
 }
 
 bool Cartridge::CpuRead(uint16_t address, uint8_t& data) {
     uint32_t mappedAddr = 0;
-    if (m_Mapper->CpuMapRead(address, mappedAddr)) {
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.CpuMapRead(address, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
         data = m_ProgramMemory[mappedAddr];
         return true;
     }
@@ -29,8 +42,11 @@ bool Cartridge::CpuRead(uint16_t address, uint8_t& data) {
 
 bool Cartridge::CpuWrite(uint16_t address, uint8_t data) {
     uint32_t mappedAddr = 0;
-    if (m_Mapper->CpuMapWrite(address, mappedAddr)) {
-        m_ProgramMemory[mappedAddr] = data;
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.CpuMapWrite(address, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
+        GetWritableProgramMemory()[mappedAddr] = data;
         return true;
     }
     return false;
@@ -38,7 +54,10 @@ bool Cartridge::CpuWrite(uint16_t address, uint8_t data) {
 
 bool Cartridge::PpuRead(uint16_t address, uint8_t& data) {
     uint32_t mappedAddr = 0;
-    if (m_Mapper->PpuMapRead(address, mappedAddr)) {
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.PpuMapRead(address, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
         data = m_CharacterMemory[mappedAddr];
         return true;
     }
@@ -47,11 +66,165 @@ bool Cartridge::PpuRead(uint16_t address, uint8_t& data) {
 
 bool Cartridge::PpuWrite(uint16_t address, uint8_t data) {
     uint32_t mappedAddr = 0;
-    if (m_Mapper->PpuMapWrite(address, mappedAddr)) {
-        m_CharacterMemory[mappedAddr] = data;
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.PpuMapWrite(address, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
+        GetWritableCharacterMemory()[mappedAddr] = data;
         return true;
     }
     return false;
 }
 
+const uint8_t* Cartridge::GetCpuReadPage(uint8_t page) {
+    uint32_t mappedAddr = 0;
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.CpuMapReadPage(page, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
+        return &m_ProgramMemory[mappedAddr];
+    }
+    return nullptr;
+}
+
+uint8_t* Cartridge::GetCpuWritePage(uint8_t page) {
+    uint32_t mappedAddr = 0;
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.CpuMapWritePage(page, mappedAddr); },
+        m_Mapper);
+    if (mapped) {
+        return &GetWritableProgramMemory()[mappedAddr];
+    }
+    return nullptr;
+}
+
+const uint8_t* Cartridge::GetPpuReadPage(uint8_t page) {
+    uint32_t mappedAddr = 0;
+    const bool mapped = std::visit(
+        [&](auto& mapper) { return mapper.PpuMapReadPage(page, mappedAddr); },
+        m_Mapper);
+    if (mapped && mappedAddr + SIZE_PPU_PAGE <= m_CharacterMemorySize) {
+        return &m_CharacterMemory[mappedAddr];
+    }
+    return nullptr;
+}
+
+bool Cartridge::ConsumeMappingChanged() {
+    const bool memoryCopied = m_MemoryCopied;
+    m_MemoryCopied = false;
+    const bool mappingChanged = std::visit(
+        [](auto& mapper) { return mapper.ConsumeMappingChanged(); }, m_Mapper);
+    return mappingChanged || memoryCopied;
+}
+
+void Cartridge::SaveState(StateWriter& writer) const {
+    CartridgeStateHeader header;
+    header.m_RomHash = m_RomImage->GetHash();
+    header.m_ProgramMemorySize =
+        static_cast<uint32_t>(m_ProgramMemoryCopy.size());
+    header.m_CharacterMemorySize =
+        static_cast<uint32_t>(m_CharacterMemoryCopy.size());
+    writer.Write(header);
+    if (!m_ProgramMemoryCopy.empty()) {
+        writer.WriteBytes(m_ProgramMemoryCopy.data(),
+                          m_ProgramMemoryCopy.size());
+    }
+    if (!m_CharacterMemoryCopy.empty()) {
+        writer.WriteBytes(m_CharacterMemoryCopy.data(),
+                          m_CharacterMemoryCopy.size());
+    }
+    std::visit([&](auto& mapper) { mapper.SaveState(writer); }, m_Mapper);
+}
+
+size_t Cartridge::GetStateSize() const {
+    StateWriter writer{nullptr};
+    SaveState(writer);
+    return writer.GetOffset();
+}
+
+size_t Cartridge::GetMaxStateSize() const {
+    const size_t characterRomSize = m_RomImage->GetCharacterMemorySize();
+    return sizeof(CartridgeStateHeader) + m_RomImage->GetProgramMemorySize() +
+           (characterRomSize > 0 ? characterRomSize : m_CharacterMemorySize) +
+           GetMapperStateSize();
+}
+
+bool Cartridge::LoadState(StateReader& reader, size_t size) {
+    if (size < sizeof(CartridgeStateHeader)) {
+        return false;
+    }
+    CartridgeStateHeader header;
+    reader.Read(header);
+
+    // The character RAM is always saved, the copies of the ROM only if the
+    // cartridge had made them
+    const size_t programRomSize = m_RomImage->GetProgramMemorySize();
+    const size_t characterRomSize = m_RomImage->GetCharacterMemorySize();
+    const bool isProgramMemorySizeValid =
+        header.m_ProgramMemorySize == 0 ||
+        header.m_ProgramMemorySize == programRomSize;
+    const bool isCharacterMemorySizeValid =
+        characterRomSize == 0
+            ? header.m_CharacterMemorySize == m_CharacterMemorySize
+            : header.m_CharacterMemorySize == 0 ||
+                  header.m_CharacterMemorySize == characterRomSize;
+    if (header.m_RomHash != m_RomImage->GetHash() ||
+        !isProgramMemorySizeValid || !isCharacterMemorySizeValid ||
+        size != sizeof(CartridgeStateHeader) + header.m_ProgramMemorySize +
+                    header.m_CharacterMemorySize + GetMapperStateSize()) {
+        return false;
+    }
+
+    const uint8_t* programMemory =
+        reader.ReadInPlace(header.m_ProgramMemorySize);
+    if (header.m_ProgramMemorySize > 0) {
+        std::memcpy(GetWritableProgramMemory(), programMemory,
+                    header.m_ProgramMemorySize);
+    } else if (!m_ProgramMemoryCopy.empty()) {
+        m_ProgramMemoryCopy.clear();
+        m_ProgramMemory = m_RomImage->GetProgramMemory();
+        m_MemoryCopied = true;
+    }
+    const uint8_t* characterMemory =
+        reader.ReadInPlace(header.m_CharacterMemorySize);
+    if (header.m_CharacterMemorySize > 0) {
+        std::memcpy(GetWritableCharacterMemory(), characterMemory,
+                    header.m_CharacterMemorySize);
+    } else if (!m_CharacterMemoryCopy.empty()) {
+        m_CharacterMemoryCopy.clear();
+        m_CharacterMemory = m_RomImage->GetCharacterMemory();
+        m_MemoryCopied = true;
+    }
+    std::visit([&](auto& mapper) { mapper.LoadState(reader); }, m_Mapper);
+    return true;
+}
+
+size_t Cartridge::GetMapperStateSize() const {
+    StateWriter writer{nullptr};
+    std::visit([&](auto& mapper) { mapper.SaveState(writer); }, m_Mapper);
+    return writer.GetOffset();
+}
+
+uint8_t* Cartridge::GetWritableProgramMemory() {
+    if (m_ProgramMemoryCopy.empty()) {
+        const uint8_t* rom = m_RomImage->GetProgramMemory();
+        m_ProgramMemoryCopy.assign(
+            rom, rom + m_RomImage->GetProgramMemorySize());
+        m_ProgramMemory = m_ProgramMemoryCopy.data();
+        m_MemoryCopied = true;
+    }
+    return m_ProgramMemoryCopy.data();
+}
+
+uint8_t* Cartridge::GetWritableCharacterMemory() {
+    if (m_CharacterMemoryCopy.empty()) {
+        const uint8_t* rom = m_RomImage->GetCharacterMemory();
+        m_CharacterMemoryCopy.assign(
+            rom, rom + m_RomImage->GetCharacterMemorySize());
+        m_CharacterMemory = m_CharacterMemoryCopy.data();
+        m_MemoryCopied = true;
+    }
+    return m_CharacterMemoryCopy.data();
+}
+
 }  // namespace dearnes
\ No newline at end of file
@@ -1,11 +1,23 @@
 #include "dear_nes_lib/cartridge_header.h"
 
+#include <cstring>
+
 namespace dearnes {
 
 CartridgeHeader::CartridgeHeader(std::ifstream& inputStream) {
 	inputStream.read(reinterpret_cast<char*>(&m_iNesHeader),
                      sizeof(m_iNesHeader));
 
+    ReadMirroringMode();
+}
+
+CartridgeHeader::CartridgeHeader(const uint8_t* data) {
+    std::memcpy(&m_iNesHeader, data, sizeof(m_iNesHeader));
+
+    ReadMirroringMode();
+}
+
+void CartridgeHeader::ReadMirroringMode() {
     m_MirroringMode = (m_iNesHeader.m_Mapper1 & 0x01)
                               ? MIRRORING_MODE::VERTICAL
                               : MIRRORING_MODE::HORIZONTAL;
@@ -2,11 +2,13 @@
 #include "dear_nes_lib/cartridge_loader.h"
 
 #include <fstream>
+#include <utility>
 #include <vector>
 
 #include "dear_nes_lib/cartridge.h"
 #include "dear_nes_lib/cartridge_header.h"
-#include "dear_nes_lib/mapper_000.h"
+#include "dear_nes_lib/mapped_file.h"
+#include "dear_nes_lib/rom_image.h"
 
 namespace dearnes {
 
@@ -15,16 +17,74 @@ class Cartridge;
 
 std::variant<CartridgeLoaderError, Cartridge*>
 CartridgeLoader::LoadNewCartridge(const std::string& fileName) {
-    std::ifstream ifs;
-    ifs.open(fileName, std::ifstream::binary);
-    
-    return LoadNewCartridge(ifs);
+    std::variant<CartridgeLoaderError, Cartridge*> result;
+
+    auto romImage = LoadRomImage(fileName);
+    if (auto error = std::get_if<CartridgeLoaderError>(&romImage)) {
+        result = *error;
+        return result;
+    }
+
+    result = CreateCartridge(
+        std::move(std::get<std::shared_ptr<const RomImage>>(romImage)));
+
+    return result;
 }
 
 std::variant<CartridgeLoaderError, Cartridge*>
 CartridgeLoader::LoadNewCartridge(std::ifstream& inputStream) {
     std::variant<CartridgeLoaderError, Cartridge*> result;
 
+    auto romImage = LoadRomImage(inputStream);
+    if (auto error = std::get_if<CartridgeLoaderError>(&romImage)) {
+        result = *error;
+        return result;
+    }
+
+    result = CreateCartridge(
+        std::move(std::get<std::shared_ptr<const RomImage>>(romImage)));
+
+    return result;
+}
+
+std::variant<CartridgeLoaderError, std::shared_ptr<const RomImage>>
+CartridgeLoader::LoadRomImage(const std::string& fileName) {
+    if (std::unique_ptr<MappedFile> mappedFile = MappedFile::Open(fileName)) {
+        if (mappedFile->GetSize() >= CartridgeHeader::SIZE) {
+            CartridgeHeader header{mappedFile->GetData()};
+            if (!IsMapperSupported(header.GetMapperId())) {
+                return CartridgeLoaderError::MAPPER_NOT_SUPPORTED;
+            }
+
+            const size_t programMemoryOffset =
+                CartridgeHeader::SIZE +
+                (header.HasTrainerData() ? CartridgeHeader::SIZE_TRAINER : 0);
+            const size_t characterMemoryOffset =
+                programMemoryOffset + header.GetProgramMemorySize();
+            const size_t characterMemorySize = header.GetCharacterMemorySize();
+            if (characterMemoryOffset + characterMemorySize <=
+                mappedFile->GetSize()) {
+                const size_t programMemorySize = header.GetProgramMemorySize();
+                return std::make_shared<const RomImage>(
+                    std::move(header), std::move(mappedFile),
+                    programMemoryOffset, programMemorySize,
+                    characterMemoryOffset, characterMemorySize);
+            }
+        }
+        // Truncated file, let the stream path handle it as it always did
+    }
+
+    // Not a regular file, or it cannot be mapped
+    std::ifstream ifs;
+    ifs.open(fileName, std::ifstream::binary);
+
+    return LoadRomImage(ifs);
+}
+
+std::variant<CartridgeLoaderError, std::shared_ptr<const RomImage>>
+CartridgeLoader::LoadRomImage(std::ifstream& inputStream) {
+    std::variant<CartridgeLoaderError, std::shared_ptr<const RomImage>> result;
+
     if (!inputStream.is_open()) {
         result = CartridgeLoaderError::FILE_NOT_FOUND;
         return result;
@@ -39,10 +99,8 @@ CartridgeLoader::LoadNewCartridge(std::ifstream& inputStream) {
         return result;
     }
 
-    IMapper* mapperPtr = CreateMapper(header);
-
     if (header.HasTrainerData()) {
-        inputStream.seekg(512, std::ios_base::cur);
+        inputStream.seekg(CartridgeHeader::SIZE_TRAINER, std::ios_base::cur);
     }
 
     std::vector<uint8_t> programMemory(header.GetProgramMemorySize());
@@ -53,13 +111,19 @@ CartridgeLoader::LoadNewCartridge(std::ifstream& inputStream) {
     inputStream.read(reinterpret_cast<char*>(characterMemory.data()),
              characterMemory.size());
 
-    result =
-        new Cartridge{std::move(header), mapperPtr, std::move(programMemory),
-                      std::move(characterMemory)};
+    result = std::make_shared<const RomImage>(std::move(header),
+                                              std::move(programMemory),
+                                              std::move(characterMemory));
 
     return result;
 }
 
+Cartridge* CartridgeLoader::CreateCartridge(
+    std::shared_ptr<const RomImage> romImage) {
+    MapperVariant mapper = CreateMapper(romImage->GetHeader());
+    return new Cartridge{std::move(romImage), std::move(mapper)};
+}
+
 bool CartridgeLoader::IsMapperSupported(uint8_t mapperId) {
     if (mapperId == 0x00) {
         return true;
@@ -67,13 +131,11 @@ bool CartridgeLoader::IsMapperSupported(uint8_t mapperId) {
     return false;
 }
 
-IMapper* CartridgeLoader::CreateMapper(const CartridgeHeader& header) {
-    if (header.GetMapperId() == 0x00) {
-        return new Mapper_000(header.GetProgramMemoryBanks(),
-                              header.GetCharacterMemoryBanks());
-    }
-    // This should not be reachable
-    return nullptr;
+MapperVariant CartridgeLoader::CreateMapper(const CartridgeHeader& header) {
+    // Mapper 000 is the only one supported for now, so every header that
+    // passed IsMapperSupported gets it
+    return Mapper_000(header.GetProgramMemoryBanks(),
+                      header.GetCharacterMemoryBanks());
 }
 
 }  // namespace dearnes
\ No newline at end of file
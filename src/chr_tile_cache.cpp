@@ -0,0 +1,91 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/chr_tile_cache.h"
+
+#include "dear_nes_lib/tile_decoder.h"
+
+namespace dearnes {
+
+namespace {
+
+// Move the bit 2k of a row to the bit k, the inverse of SPREAD_BITS_TABLE
+uint8_t CompactBits(uint16_t spread) {
+    spread &= 0x5555;
+    spread = (spread | (spread >> 1)) & 0x3333;
+    spread = (spread | (spread >> 2)) & 0x0F0F;
+    spread = (spread | (spread >> 4)) & 0x00FF;
+    return static_cast<uint8_t>(spread);
+}
+
+}  // namespace
+
+void ChrTileCache::EncodeRow(uint16_t row, uint8_t& lo, uint8_t& hi) {
+    lo = CompactBits(row);
+    hi = CompactBits(row >> 1);
+}
+
+uint16_t ChrTileCache::FlipRow(uint16_t row) {
+    row = static_cast<uint16_t>((row >> 8) | (row << 8));
+    row = ((row & 0xF0F0) >> 4) | ((row & 0x0F0F) << 4);
+    row = ((row & 0xCCCC) >> 2) | ((row & 0x3333) << 2);
+    return row;
+}
+
+void ChrTileCache::SetPage(size_t page, const uint8_t* memory) {
+    if (m_Pages[page] == memory) {
+        return;
+    }
+    m_Pages[page] = memory;
+    m_IsPageStale[page] = true;
+    for (size_t tileIdx = page * TILES_PER_PAGE;
+         tileIdx < (page + 1) * TILES_PER_PAGE; ++tileIdx) {
+        m_IsTileValid[tileIdx] = false;
+    }
+}
+
+void ChrTileCache::InvalidateTile(uint16_t address) {
+    m_IsTileValid[(address & 0x1FFF) >> 4] = false;
+}
+
+void ChrTileCache::InvalidateAll() {
+    m_IsTileValid.fill(false);
+    m_IsPageStale.fill(true);
+}
+
+bool ChrTileCache::DecodeTile(size_t tileIdx) {
+    const size_t pageIdx = tileIdx / TILES_PER_PAGE;
+    const uint8_t* page = m_Pages[pageIdx];
+    if (page == nullptr) {
+        return false;
+    }
+    if (m_IsPageStale[pageIdx]) {
+        DecodePage(pageIdx);
+        return true;
+    }
+
+    // A tile dropped by a write, the SIMD kernels would not pay off for it
+    const uint8_t* data = &page[(tileIdx % TILES_PER_PAGE) * SIZE_TILE];
+    Tile& tile = m_Tiles[tileIdx];
+    for (size_t row = 0; row < 8; ++row) {
+        tile.m_Rows[row] = DecodeTileRow(data[row], data[row + 8]);
+        tile.m_FlippedRows[row] = FlipRow(tile.m_Rows[row]);
+    }
+    m_IsTileValid[tileIdx] = true;
+    return true;
+}
+
+void ChrTileCache::DecodePage(size_t pageIdx) {
+    uint16_t rows[TILES_PER_PAGE * 8];
+    DecodeTiles(m_Pages[pageIdx], TILES_PER_PAGE, rows);
+    for (size_t i = 0; i < TILES_PER_PAGE; ++i) {
+        const size_t tileIdx = pageIdx * TILES_PER_PAGE + i;
+        Tile& tile = m_Tiles[tileIdx];
+        for (size_t row = 0; row < 8; ++row) {
+            tile.m_Rows[row] = rows[i * 8 + row];
+            tile.m_FlippedRows[row] = FlipRow(tile.m_Rows[row]);
+        }
+        m_IsTileValid[tileIdx] = true;
+    }
+    m_IsPageStale[pageIdx] = false;
+}
+
+}  // namespace dearnes
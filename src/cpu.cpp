@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "dear_nes_lib/bus.h"
+#include "dear_nes_lib/save_state.h"
 
 namespace dearnes {
 
@@ -28,6 +29,36 @@ void Cpu::Reset() {
     m_Cycles = 8;
 }
 
+void Cpu::SaveState(StateWriter& writer) const {
+    writer.Write(m_RegisterA);
+    writer.Write(m_RegisterX);
+    writer.Write(m_RegisterY);
+    writer.Write(m_StackPointer);
+    writer.Write(m_StatusRegister);
+    writer.Write(m_ProgramCounter);
+    writer.Write(m_AddressAbsolute);
+    writer.Write(m_AddressRelative);
+    writer.Write(m_OpCode);
+    writer.Write(m_Cycles);
+    writer.Write(m_AddressingModeNeedsAdditionalCycle);
+    writer.Write(m_InstructionNeedsAdditionalCycle);
+}
+
+void Cpu::LoadState(StateReader& reader) {
+    reader.Read(m_RegisterA);
+    reader.Read(m_RegisterX);
+    reader.Read(m_RegisterY);
+    reader.Read(m_StackPointer);
+    reader.Read(m_StatusRegister);
+    reader.Read(m_ProgramCounter);
+    reader.Read(m_AddressAbsolute);
+    reader.Read(m_AddressRelative);
+    reader.Read(m_OpCode);
+    reader.Read(m_Cycles);
+    reader.Read(m_AddressingModeNeedsAdditionalCycle);
+    reader.Read(m_InstructionNeedsAdditionalCycle);
+}
+
 void Cpu::Clock() {
     if (m_Cycles == 0) {
         m_OpCode = ReadWordFromProgramCounter();
@@ -35,17 +66,12 @@ void Cpu::Clock() {
         SetFlag(CpuFlag::U, 1);
 
         // TODO: Catch exception illegal instruction
-        const Instruction& instr = FindInstruction(m_OpCode);
-
-        m_Cycles = instr.m_Cycles;
-
-        if (instr.m_ExecureAddressingMode) {
-            (this->*instr.m_ExecureAddressingMode)();
+        if (m_DispatchMode == DispatchMode::FUSED) {
+            (this->*m_FusedInstructionTable[m_OpCode])();
+        } else {
+            ExecuteFromInstructionTable();
         }
 
-        assert(instr.m_ExecuteInstruction != nullptr);
-        (this->*instr.m_ExecuteInstruction)();
-
         if (m_AddressingModeNeedsAdditionalCycle &&
             m_InstructionNeedsAdditionalCycle) {
             ++m_Cycles;
@@ -57,6 +83,19 @@ void Cpu::Clock() {
     m_Cycles--;
 }
 
+void Cpu::ExecuteFromInstructionTable() {
+    const Instruction& instr = FindInstruction(m_OpCode);
+
+    m_Cycles = instr.m_Cycles;
+
+    if (instr.m_ExecureAddressingMode) {
+        (this->*instr.m_ExecureAddressingMode)();
+    }
+
+    assert(instr.m_ExecuteInstruction != nullptr);
+    (this->*instr.m_ExecuteInstruction)();
+}
+
 void Cpu::NonMaskableInterrupt() {
     Write(0x0100 + m_StackPointer, (m_ProgramCounter >> 8) & 0x00FF);
     m_StackPointer--;
@@ -620,7 +659,14 @@ void Cpu::InstrTYA() {
 
 void Cpu::InstrNoImpl() { return; }
 
-Cpu::Instruction Cpu::m_InstructionTable[0x100] = {
+constexpr Cpu::Instruction::Instruction(const FuncPtr executeInstruction,
+                                        const FuncPtr execureAddressingMode,
+                                        const uint8_t cycles)
+    : m_ExecuteInstruction{executeInstruction},
+      m_ExecureAddressingMode{execureAddressingMode},
+      m_Cycles{cycles} {}
+
+constexpr Cpu::Instruction Cpu::m_InstructionTable[0x100] = {
     Instruction{&Cpu::InstrBRK, nullptr, 7},                     // 0x00
     Instruction{&Cpu::InstrORA, &Cpu::AddrIndexedIndirectX, 6},  // 0x01
     Instruction{&Cpu::InstrNoImpl, nullptr, 0},                  // 0x02
@@ -879,17 +925,27 @@ Cpu::Instruction Cpu::m_InstructionTable[0x100] = {
     Instruction{&Cpu::InstrNoImpl, nullptr, 0}                   // 0xFF
 };
 
-constexpr Cpu::Instruction::Instruction(const FuncPtr executeInstruction,
-                                        const FuncPtr execureAddressingMode,
-                                        const uint8_t cycles)
-    : m_ExecuteInstruction{executeInstruction},
-      m_ExecureAddressingMode{execureAddressingMode},
-      m_Cycles{cycles} {}
-
 constexpr const Cpu::Instruction& Cpu::FindInstruction(const uint8_t opCode) {
     using Instruction = Cpu::Instruction;
 
     return m_InstructionTable[opCode];
 }
 
+template <uint8_t OpCode>
+void Cpu::ExecuteOpCode() {
+    constexpr Instruction instr = m_InstructionTable[OpCode];
+    static_assert(instr.m_ExecuteInstruction != nullptr);
+
+    m_Cycles = instr.m_Cycles;
+
+    if constexpr (instr.m_ExecureAddressingMode != nullptr) {
+        (this->*instr.m_ExecureAddressingMode)();
+    }
+
+    (this->*instr.m_ExecuteInstruction)();
+}
+
+const std::array<Cpu::FuncPtr, 0x100> Cpu::m_FusedInstructionTable =
+    Cpu::MakeFusedInstructionTable(std::make_index_sequence<0x100>{});
+
 }  // namespace dearnes
\ No newline at end of file
@@ -0,0 +1,336 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "dear_nes_lib/bus.h"
+#include "dear_nes_lib/cpu.h"
+#include "dear_nes_lib/dma.h"
+#include "dear_nes_lib/ppu.h"
+
+// Microbenchmark of the CPU instruction dispatch. Each documented op code is
+// repeated over a block of RAM and run with both Cpu::DispatchMode values.
+
+using Cpu = dearnes::Cpu;
+
+namespace {
+
+struct OpCodeInfo {
+    uint8_t m_OpCode;
+    const char* m_Name;
+    const char* m_AddressingMode;
+    uint8_t m_Length;
+};
+
+constexpr OpCodeInfo OPCODES[] = {
+    {0x00, "BRK", "IMP", 1},
+    {0x01, "ORA", "IZX", 2},
+    {0x05, "ORA", "ZP0", 2},
+    {0x06, "ASL", "ZP0", 2},
+    {0x08, "PHP", "IMP", 1},
+    {0x09, "ORA", "IMM", 2},
+    {0x0A, "ASL", "ACC", 1},
+    {0x0D, "ORA", "ABS", 3},
+    {0x0E, "ASL", "ABS", 3},
+    {0x10, "BPL", "REL", 2},
+    {0x11, "ORA", "IZY", 2},
+    {0x15, "ORA", "ZPX", 2},
+    {0x16, "ASL", "ZPX", 2},
+    {0x18, "CLC", "IMP", 1},
+    {0x19, "ORA", "ABY", 3},
+    {0x1D, "ORA", "ABX", 3},
+    {0x1E, "ASL", "ABX", 3},
+    {0x20, "JSR", "ABS", 3},
+    {0x21, "AND", "IZX", 2},
+    {0x24, "BIT", "ZP0", 2},
+    {0x25, "AND", "ZP0", 2},
+    {0x26, "ROL", "ZP0", 2},
+    {0x28, "PLP", "IMP", 1},
+    {0x29, "AND", "IMM", 2},
+    {0x2A, "ROL", "ACC", 1},
+    {0x2C, "BIT", "ABS", 3},
+    {0x2D, "AND", "ABS", 3},
+    {0x2E, "ROL", "ABS", 3},
+    {0x30, "BMI", "REL", 2},
+    {0x31, "AND", "IZY", 2},
+    {0x35, "AND", "ZPX", 2},
+    {0x36, "ROL", "ZPX", 2},
+    {0x38, "SEC", "IMP", 1},
+    {0x39, "AND", "ABY", 3},
+    {0x3D, "AND", "ABX", 3},
+    {0x3E, "ROL", "ABX", 3},
+    {0x40, "RTI", "IMP", 1},
+    {0x41, "EOR", "IZX", 2},
+    {0x45, "EOR", "ZP0", 2},
+    {0x46, "LSR", "ZP0", 2},
+    {0x48, "PHA", "IMP", 1},
+    {0x49, "EOR", "IMM", 2},
+    {0x4A, "LSR", "ACC", 1},
+    {0x4C, "JMP", "ABS", 3},
+    {0x4D, "EOR", "ABS", 3},
+    {0x4E, "LSR", "ABS", 3},
+    {0x50, "BVC", "REL", 2},
+    {0x51, "EOR", "IZY", 2},
+    {0x55, "EOR", "ZPX", 2},
+    {0x56, "LSR", "ZPX", 2},
+    {0x58, "CLI", "IMP", 1},
+    {0x59, "EOR", "ABY", 3},
+    {0x5D, "EOR", "ABX", 3},
+    {0x5E, "LSR", "ABX", 3},
+    {0x60, "RTS", "IMP", 1},
+    {0x61, "ADC", "IZX", 2},
+    {0x65, "ADC", "ZP0", 2},
+    {0x66, "ROR", "ZP0", 2},
+    {0x68, "PLA", "IMP", 1},
+    {0x69, "ADC", "IMM", 2},
+    {0x6A, "ROR", "ACC", 1},
+    {0x6C, "JMP", "IND", 3},
+    {0x6D, "ADC", "ABS", 3},
+    {0x6E, "ROR", "ABS", 3},
+    {0x70, "BVS", "REL", 2},
+    {0x71, "ADC", "IZY", 2},
+    {0x75, "ADC", "ZPX", 2},
+    {0x76, "ROR", "ZPX", 2},
+    {0x78, "SEI", "IMP", 1},
+    {0x79, "ADC", "ABY", 3},
+    {0x7D, "ADC", "ABX", 3},
+    {0x7E, "ROR", "ABX", 3},
+    {0x81, "STA", "IZX", 2},
+    {0x84, "STY", "ZP0", 2},
+    {0x85, "STA", "ZP0", 2},
+    {0x86, "STX", "ZP0", 2},
+    {0x88, "DEY", "IMP", 1},
+    {0x8A, "TXA", "IMP", 1},
+    {0x8C, "STY", "ABS", 3},
+    {0x8D, "STA", "ABS", 3},
+    {0x8E, "STX", "ABS", 3},
+    {0x90, "BCC", "REL", 2},
+    {0x91, "STA", "IZY", 2},
+    {0x94, "STY", "ZPX", 2},
+    {0x95, "STA", "ZPX", 2},
+    {0x96, "STX", "ZPY", 2},
+    {0x98, "TYA", "IMP", 1},
+    {0x99, "STA", "ABY", 3},
+    {0x9A, "TXS", "IMP", 1},
+    {0x9D, "STA", "ABX", 3},
+    {0xA0, "LDY", "IMM", 2},
+    {0xA1, "LDA", "IZX", 2},
+    {0xA2, "LDX", "IMM", 2},
+    {0xA4, "LDY", "ZP0", 2},
+    {0xA5, "LDA", "ZP0", 2},
+    {0xA6, "LDX", "ZP0", 2},
+    {0xA8, "TAY", "IMP", 1},
+    {0xA9, "LDA", "IMM", 2},
+    {0xAA, "TAX", "IMP", 1},
+    {0xAC, "LDY", "ABS", 3},
+    {0xAD, "LDA", "ABS", 3},
+    {0xAE, "LDX", "ABS", 3},
+    {0xB0, "BCS", "REL", 2},
+    {0xB1, "LDA", "IZY", 2},
+    {0xB4, "LDY", "ZPX", 2},
+    {0xB5, "LDA", "ZPX", 2},
+    {0xB6, "LDX", "ZPY", 2},
+    {0xB8, "CLV", "IMP", 1},
+    {0xB9, "LDA", "ABY", 3},
+    {0xBA, "TSX", "IMP", 1},
+    {0xBC, "LDY", "ABX", 3},
+    {0xBD, "LDA", "ABX", 3},
+    {0xBE, "LDX", "ABY", 3},
+    {0xC0, "CPY", "IMM", 2},
+    {0xC1, "CMP", "IZX", 2},
+    {0xC4, "CPY", "ZP0", 2},
+    {0xC5, "CMP", "ZP0", 2},
+    {0xC6, "DEC", "ZP0", 2},
+    {0xC8, "INY", "IMP", 1},
+    {0xC9, "CMP", "IMM", 2},
+    {0xCA, "DEX", "IMP", 1},
+    {0xCC, "CPY", "ABS", 3},
+    {0xCD, "CMP", "ABS", 3},
+    {0xCE, "DEC", "ABS", 3},
+    {0xD0, "BNE", "REL", 2},
+    {0xD1, "CMP", "IZY", 2},
+    {0xD5, "CMP", "ZPX", 2},
+    {0xD6, "DEC", "ZPX", 2},
+    {0xD8, "CLD", "IMP", 1},
+    {0xD9, "CMP", "ABY", 3},
+    {0xDD, "CMP", "ABX", 3},
+    {0xDE, "DEC", "ABX", 3},
+    {0xE0, "CPX", "IMM", 2},
+    {0xE1, "SBC", "IZX", 2},
+    {0xE4, "CPX", "ZP0", 2},
+    {0xE5, "SBC", "ZP0", 2},
+    {0xE6, "INC", "ZP0", 2},
+    {0xE8, "INX", "IMP", 1},
+    {0xE9, "SBC", "IMM", 2},
+    {0xEA, "NOP", "IMP", 1},
+    {0xEC, "CPX", "ABS", 3},
+    {0xED, "SBC", "ABS", 3},
+    {0xEE, "INC", "ABS", 3},
+    {0xF0, "BEQ", "REL", 2},
+    {0xF1, "SBC", "IZY", 2},
+    {0xF5, "SBC", "ZPX", 2},
+    {0xF6, "INC", "ZPX", 2},
+    {0xF8, "SED", "IMP", 1},
+    {0xF9, "SBC", "ABY", 3},
+    {0xFD, "SBC", "ABX", 3},
+    {0xFE, "INC", "ABX", 3},
+};
+
+// Memory layout of the benchmark. The reset vector reads as $0000 without a
+// cartridge, so a JMP there leads to the code block.
+constexpr uint16_t CODE_START = 0x0400;
+constexpr uint16_t CODE_END = 0x0800;
+constexpr uint8_t ZERO_PAGE_OPERAND = 0x10;
+constexpr uint8_t INDIRECT_OPERAND = 0x80;
+constexpr uint16_t ABSOLUTE_OPERAND = 0x0300;
+
+// Each measurement is repeated, alternating the modes, and the fastest run is
+// kept to filter out the noise from the rest of the system
+constexpr int REPETITIONS = 5;
+
+constexpr uint8_t OPCODE_JSR = 0x20;
+constexpr uint8_t OPCODE_JMP = 0x4C;
+
+bool IsBenchmarkable(const OpCodeInfo& info) {
+    // These ones take the program counter from the stack or from a vector,
+    // so they can not be repeated in a straight line
+    const std::string name = info.m_Name;
+    return name != "BRK" && name != "RTI" && name != "RTS" &&
+           std::string{info.m_AddressingMode} != "IND";
+}
+
+/// <summary>
+/// CPU with its own bus, PPU and DMA. There is no cartridge, so the code runs
+/// from RAM.
+/// </summary>
+struct BenchmarkSystem {
+    dearnes::Bus m_Bus;
+    dearnes::Dma m_Dma;
+    dearnes::Ppu m_Ppu;
+    Cpu m_Cpu;
+
+    BenchmarkSystem() {
+        m_Bus.SetPpu(&m_Ppu);
+        m_Bus.SetDma(&m_Dma);
+        m_Dma.SetBus(&m_Bus);
+        m_Cpu.SetBus(&m_Bus);
+    }
+
+    void WriteWord(uint16_t address, uint16_t value) {
+        m_Bus.CpuWrite(address, value & 0x00FF);
+        m_Bus.CpuWrite(address + 1, value >> 8);
+    }
+
+    /// <summary>
+    /// Fill the code block with the op code, followed by a jump back to the
+    /// start of the block. Returns how many times the op code was written.
+    /// </summary>
+    size_t LoadProgram(const OpCodeInfo& info) {
+        m_Bus.CpuWrite(0x0000, OPCODE_JMP);
+        WriteWord(0x0001, CODE_START);
+        WriteWord(INDIRECT_OPERAND, ABSOLUTE_OPERAND);
+
+        size_t count = 0;
+        uint16_t address = CODE_START;
+        while (address + info.m_Length + 3 <= CODE_END) {
+            const uint16_t next = address + info.m_Length;
+            m_Bus.CpuWrite(address, info.m_OpCode);
+            if (info.m_OpCode == OPCODE_JSR || info.m_OpCode == OPCODE_JMP) {
+                WriteWord(address + 1, next);
+            } else if (std::string{info.m_AddressingMode} == "REL") {
+                // Taken or not, a branch with offset 0 goes to the next one
+                m_Bus.CpuWrite(address + 1, 0x00);
+            } else if (std::string{info.m_AddressingMode} == "IZX" ||
+                       std::string{info.m_AddressingMode} == "IZY") {
+                m_Bus.CpuWrite(address + 1, INDIRECT_OPERAND);
+            } else if (info.m_Length == 2) {
+                m_Bus.CpuWrite(address + 1, ZERO_PAGE_OPERAND);
+            } else if (info.m_Length == 3) {
+                WriteWord(address + 1, ABSOLUTE_OPERAND);
+            }
+            address = next;
+            ++count;
+        }
+        m_Bus.CpuWrite(address, OPCODE_JMP);
+        WriteWord(address + 1, CODE_START);
+        return count;
+    }
+
+    void RunInstruction() {
+        do {
+            m_Cpu.Clock();
+        } while (!m_Cpu.IsCurrentInstructionComplete());
+    }
+};
+
+/// <summary>
+/// Returns the average time per instruction, in nanoseconds
+/// </summary>
+double Benchmark(const OpCodeInfo& info, Cpu::DispatchMode mode,
+                 uint64_t instructions) {
+    BenchmarkSystem system;
+    system.LoadProgram(info);
+    system.m_Cpu.SetDispatchMode(mode);
+    system.m_Cpu.Reset();
+    // Consume the reset cycles and the jump to the code block
+    system.RunInstruction();
+    system.RunInstruction();
+
+    const auto startTime = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < instructions; ++i) {
+        system.RunInstruction();
+    }
+    const auto endTime = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(endTime - startTime)
+               .count() /
+           instructions;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t instructions = 1000000;
+    if (argc > 1) {
+        instructions = std::strtoull(argv[1], nullptr, 10);
+    }
+    if (instructions == 0) {
+        fmt::print("Usage: dear_nes_cpu_bench [instructions per op code]\n");
+        return 1;
+    }
+
+    fmt::print("{:<6} {:<4} {:<4} {:>12} {:>12} {:>8}\n", "OpCode", "Name",
+               "Mode", "Table ns", "Fused ns", "Speedup");
+
+    double logSpeedupSum = 0.0;
+    size_t benchmarked = 0;
+    for (const OpCodeInfo& info : OPCODES) {
+        if (!IsBenchmarkable(info)) {
+            continue;
+        }
+        double tableTime = HUGE_VAL;
+        double fusedTime = HUGE_VAL;
+        for (int i = 0; i < REPETITIONS; ++i) {
+            tableTime = std::fmin(
+                tableTime, Benchmark(info, Cpu::DispatchMode::INSTRUCTION_TABLE,
+                                     instructions));
+            fusedTime = std::fmin(
+                fusedTime,
+                Benchmark(info, Cpu::DispatchMode::FUSED, instructions));
+        }
+        const double speedup = tableTime / fusedTime;
+        logSpeedupSum += std::log(speedup);
+        ++benchmarked;
+
+        fmt::print("0x{:02X}   {:<4} {:<4} {:>12.2f} {:>12.2f} {:>7.2f}x\n",
+                   info.m_OpCode, info.m_Name, info.m_AddressingMode,
+                   tableTime, fusedTime, speedup);
+    }
+
+    fmt::print("\n{} op codes, geometric mean speedup: {:.2f}x\n", benchmarked,
+               std::exp(logSpeedupSum / benchmarked));
+    return 0;
+}
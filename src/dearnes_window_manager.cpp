@@ -3,6 +3,7 @@
 
 #include <imgui.h>
 
+#include "dear_nes_lib/emulation_thread.h"
 #include "dear_nes_lib/nes.h"
 #include "include/controller_widget.h"
 #include "include/cpu_widget.h"
@@ -15,11 +16,12 @@
 #include <GLFW/glfw3.h>
 
 using Nes = dearnes::Nes;
-DearNESWindowManager::DearNESWindowManager(dearnes::Nes* nesPtr)
-: m_NesPtr{nesPtr} {}
+DearNESWindowManager::DearNESWindowManager(
+    dearnes::Nes* nesPtr, dearnes::EmulationThread* emulationThreadPtr)
+    : m_NesPtr{nesPtr}, m_EmulationThreadPtr{emulationThreadPtr} {}
 
 void DearNESWindowManager::RegisterWidgets() {
-    AddWidget(new ScreenWidget(m_NesPtr));
+    AddWidget(new ScreenWidget(m_NesPtr, m_EmulationThreadPtr));
     m_NesStatusWindow =
         dynamic_cast<StatusWidget*>(AddWidget(new StatusWidget(m_NesPtr)));
     AddWidget(new CpuWidget(m_NesPtr));
@@ -35,31 +37,38 @@ void DearNESWindowManager::ProcessInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
-    // TODO: define constants for NES buttons
-    using dearnes::CONTROLLER_PLAYER_1_IDX;
-    m_NesPtr->ClearControllerState(CONTROLLER_PLAYER_1_IDX);
+    m_EmulationThreadPtr->SetRewinding(
+        glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS);
+
+    uint8_t buttons = 0;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x80);
+        buttons |= dearnes::BUTTON_A;
     }
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x40);
+        buttons |= dearnes::BUTTON_B;
     }
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x20);
+        buttons |= dearnes::BUTTON_SELECT;
     }
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x10);
+        buttons |= dearnes::BUTTON_START;
     }
     if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x08);
+        buttons |= dearnes::BUTTON_UP;
     }
     if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x04);
+        buttons |= dearnes::BUTTON_DOWN;
     }
     if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x02);
+        buttons |= dearnes::BUTTON_LEFT;
     }
     if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-        m_NesPtr->WriteControllerState(CONTROLLER_PLAYER_1_IDX, 0x01);
+        buttons |= dearnes::BUTTON_RIGHT;
+    }
+    // Retried on the next call if the queue is full
+    if (buttons != m_LastButtons &&
+        m_EmulationThreadPtr->SendControllerState(
+            dearnes::CONTROLLER_PLAYER_1_IDX, buttons)) {
+        m_LastButtons = buttons;
     }
 }
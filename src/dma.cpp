@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "dear_nes_lib/bus.h"
+#include "dear_nes_lib/save_state.h"
 
 namespace dearnes {
 
@@ -32,6 +33,21 @@ std::pair<uint8_t, uint8_t> Dma::GetLastReadData() {
     return {lastAddr, m_DmaData};
 }
 
+const uint8_t* Dma::GetDirectSourcePage() const {
+    assert(m_DmaAddress == 0x00);
+    const uint16_t address = m_DmaPage << 8;
+    const uint8_t* page = m_Bus->GetReadPage(address >> CPU_PAGE_SHIFT);
+    if (page == nullptr) {
+        return nullptr;
+    }
+    return &page[address & (SIZE_CPU_PAGE - 1)];
+}
+
+void Dma::FinishDirectTransfer() {
+    m_DmaData = GetDirectSourcePage()[0xFF];
+    FinishTransfer();
+}
+
 void Dma::FinishTransfer() {
     m_DmaTransfer = false;
     m_DmaWait = true;
@@ -45,4 +61,20 @@ void Dma::Reset() {
     m_DmaTransfer = false;
 }
 
+void Dma::SaveState(StateWriter& writer) const {
+    writer.Write(m_DmaPage);
+    writer.Write(m_DmaAddress);
+    writer.Write(m_DmaData);
+    writer.Write(m_DmaTransfer);
+    writer.Write(m_DmaWait);
+}
+
+void Dma::LoadState(StateReader& reader) {
+    reader.Read(m_DmaPage);
+    reader.Read(m_DmaAddress);
+    reader.Read(m_DmaData);
+    reader.Read(m_DmaTransfer);
+    reader.Read(m_DmaWait);
+}
+
 }  // namespace dearnes
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/emulation_thread.h"
+
+#include <cassert>
+
+#include "dear_nes_lib/frame_pacer.h"
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/ppu.h"
+
+namespace dearnes {
+
+namespace {
+
+constexpr size_t NUM_SCREEN_PIXELS = 256 * 240;
+
+}  // namespace
+
+EmulationThread::EmulationThread(Nes* nes, size_t rewindMemoryBudget)
+    : m_Nes{nes},
+      m_RewindBuffer{rewindMemoryBudget},
+      m_Frames{std::vector<int>(NUM_SCREEN_PIXELS)} {}
+
+EmulationThread::~EmulationThread() { Stop(); }
+
+void EmulationThread::Start() {
+    if (m_Thread.joinable()) {
+        return;
+    }
+    m_IsStopRequested.store(false, std::memory_order_relaxed);
+    m_Thread = std::thread{&EmulationThread::Run, this};
+}
+
+void EmulationThread::Stop() {
+    if (!m_Thread.joinable()) {
+        return;
+    }
+    m_IsStopRequested.store(true, std::memory_order_relaxed);
+    m_Thread.join();
+}
+
+bool EmulationThread::SendControllerState(size_t controllerIdx,
+                                          uint8_t buttons) {
+    assert(controllerIdx < NUM_CONTROLLERS);
+    return m_InputQueue.Push(
+        {static_cast<uint8_t>(controllerIdx), buttons});
+}
+
+const int* EmulationThread::AcquireFrame() {
+    return m_Frames.Acquire() ? m_Frames.GetFrontBuffer().data() : nullptr;
+}
+
+void EmulationThread::Run() {
+    // The pacer only waits outside of the lock, so the time spent in a frame
+    // or waiting for the mutex does not accumulate as drift
+    FramePacer pacer;
+    while (!m_IsStopRequested.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock{m_NesMutex};
+            RunFrame();
+            PublishFrame();
+        }
+        pacer.WaitForNextFrame();
+    }
+}
+
+void EmulationThread::RunFrame() {
+    ControllerInput input;
+    while (m_InputQueue.Pop(input)) {
+        m_Nes->ClearControllerState(input.m_ControllerIdx);
+        m_Nes->WriteControllerState(input.m_ControllerIdx, input.m_Buttons);
+    }
+
+    if (!m_IsRunning.load(std::memory_order_relaxed) ||
+        !m_Nes->IsCartridgeLoaded()) {
+        return;
+    }
+    // The history of the game before a reset, or of another cartridge, must
+    // not be restored
+    const uint64_t resetCount = m_Nes->GetResetCount();
+    if (resetCount != m_RewindResetCount) {
+        m_RewindBuffer.Clear();
+        m_RewindResetCount = resetCount;
+    }
+    if (m_IsRewinding.load(std::memory_order_relaxed) &&
+        m_RewindBuffer.Rewind(*m_Nes)) {
+        // Draw the restored frame, without recording it
+        m_Nes->DoFrame();
+    } else {
+        m_Nes->DoFrame();
+        m_RewindBuffer.Push(*m_Nes);
+    }
+    m_FrameCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EmulationThread::PublishFrame() {
+    const uint64_t frameCount = m_Nes->GetCompletedFrameCount();
+    if (frameCount == m_PublishedFrameCount) {
+        return;
+    }
+    // Converted straight into the back buffer, the frame is not copied
+    Ppu::ConvertToArgb(m_Nes->GetCompletedIndexedFrame(), NUM_SCREEN_PIXELS,
+                       m_Frames.GetBackBuffer().data());
+    m_Frames.Publish();
+    m_PublishedFrameCount = frameCount;
+}
+
+}  // namespace dearnes
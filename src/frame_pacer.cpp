@@ -0,0 +1,114 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace dearnes {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Spin margin before the first sleeps are measured, and its bounds. The
+// margin is an estimate of the oversleep that 95% of the sleeps stay under,
+// plus some slack. Covering every sleep would make the thread spin for
+// milliseconds on machines with a few very late wake ups.
+constexpr std::chrono::nanoseconds INITIAL_SPIN_MARGIN = 1ms;
+constexpr std::chrono::nanoseconds MIN_SPIN_MARGIN = 200us;
+constexpr std::chrono::nanoseconds MAX_SPIN_MARGIN = 4ms;
+constexpr std::chrono::nanoseconds SPIN_MARGIN_SLACK = 100us;
+constexpr double OVERSLEEP_QUANTILE = 0.95;
+
+// Adjustment of the estimate per sleep. It moves up by quantile times this
+// step after a sleep above it, and down by (1 - quantile) times this step
+// otherwise, which settles where the given fraction of sleeps is below.
+constexpr double OVERSLEEP_STEP_NS = 50000.0;
+
+// Past this many late frames the deadlines are restarted instead of running
+// the frames back to back, for instance after the machine was suspended
+constexpr uint64_t MAX_LATE_FRAMES = 4;
+
+}  // namespace
+
+FramePacer::FramePacer(double frameRate)
+    : m_FramePeriodNs{1e9 / frameRate},
+      m_Start{Clock::now()},
+      m_OversleepNs{static_cast<double>(
+          (INITIAL_SPIN_MARGIN - SPIN_MARGIN_SLACK).count())},
+      m_SpinMargin{
+          std::chrono::duration_cast<Clock::duration>(INITIAL_SPIN_MARGIN)} {}
+
+void FramePacer::Reset() {
+    m_Start = Clock::now();
+    m_NextFrameIdx = 1;
+}
+
+void FramePacer::WaitForNextFrame() {
+    const Clock::time_point deadline = GetDeadline(m_NextFrameIdx);
+    Clock::time_point now = Clock::now();
+    if (now - deadline > std::chrono::duration<double, std::nano>(
+                             MAX_LATE_FRAMES * m_FramePeriodNs)) {
+        ++m_Stats.m_ResyncCount;
+        Reset();
+        return;
+    }
+
+    const Clock::time_point wakeUpTime = deadline - m_SpinMargin;
+    if (now < wakeUpTime) {
+        std::this_thread::sleep_until(wakeUpTime);
+        now = Clock::now();
+
+        const double oversleepNs =
+            std::chrono::duration<double, std::nano>(now - wakeUpTime).count();
+        m_OversleepNs +=
+            OVERSLEEP_STEP_NS * (oversleepNs > m_OversleepNs
+                                     ? OVERSLEEP_QUANTILE
+                                     : OVERSLEEP_QUANTILE - 1.0);
+        m_OversleepNs = std::max(m_OversleepNs, 0.0);
+        const auto spinMargin = std::clamp<std::chrono::nanoseconds>(
+            std::chrono::nanoseconds{static_cast<int64_t>(m_OversleepNs)} +
+                SPIN_MARGIN_SLACK,
+            MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+        m_SpinMargin = std::chrono::duration_cast<Clock::duration>(spinMargin);
+    }
+    while (now < deadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+
+    RecordJitter(now - deadline);
+    ++m_NextFrameIdx;
+}
+
+void FramePacer::ResetJitterStats() {
+    m_Stats = JitterStats{};
+    m_JitterSum = 0.0;
+    m_JitterSquareSum = 0.0;
+}
+
+FramePacer::Clock::time_point FramePacer::GetDeadline(uint64_t frameIdx) const {
+    return m_Start + std::chrono::duration_cast<Clock::duration>(
+                         std::chrono::duration<double, std::nano>(
+                             frameIdx * m_FramePeriodNs));
+}
+
+void FramePacer::RecordJitter(Clock::duration lateness) {
+    const double jitter =
+        std::chrono::duration<double, std::micro>(lateness).count();
+    ++m_Stats.m_FrameCount;
+    m_JitterSum += jitter;
+    m_JitterSquareSum += jitter * jitter;
+
+    const double count = static_cast<double>(m_Stats.m_FrameCount);
+    m_Stats.m_MeanJitter = m_JitterSum / count;
+    m_Stats.m_StdDevJitter = std::sqrt(std::max(
+        0.0, m_JitterSquareSum / count -
+                 m_Stats.m_MeanJitter * m_Stats.m_MeanJitter));
+    m_Stats.m_MaxJitter = std::max(m_Stats.m_MaxJitter, jitter);
+    m_Stats.m_SpinMargin =
+        std::chrono::duration<double, std::micro>(m_SpinMargin).count();
+}
+
+}  // namespace dearnes
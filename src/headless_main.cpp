@@ -0,0 +1,376 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dear_nes_lib/cartridge_loader.h"
+#include "dear_nes_lib/enums.h"
+#include "dear_nes_lib/frame_pacer.h"
+#include "dear_nes_lib/input_movie.h"
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/rewind_buffer.h"
+
+using Nes = dearnes::Nes;
+using Cartridge = dearnes::Cartridge;
+
+namespace {
+
+/// <summary>
+/// Controller #1 state that applies from a given frame onwards, until the
+/// next entry of the script.
+/// </summary>
+struct ScriptedInput {
+    uint64_t m_Frame = 0;
+    uint8_t m_Buttons = 0x00;
+};
+
+struct Options {
+    std::string m_RomPath = "res/roms/nestest.nes";
+    std::string m_ScriptPath;
+    uint64_t m_Frames = 3600;
+    uint64_t m_WarmupFrames = 60;
+    // Rewind history budget in MB, 0 to disable it
+    uint64_t m_RewindBudget = 0;
+    uint32_t m_RunAheadFrames = 0;
+    std::string m_RecordPath;
+    std::string m_PlayPath;
+    // Frame of the played movie to seek to after the run, if any
+    int64_t m_SeekFrame = -1;
+    // Run the measured frames at the speed of the console
+    bool m_IsRealTime = false;
+    Nes::ExecutionMode m_ExecutionMode = Nes::ExecutionMode::INSTRUCTION_STEPPED;
+};
+
+void PrintUsage() {
+    fmt::print(
+        "Usage: dear_nes_headless [rom] [--frames N] [--warmup N] "
+        "[--script file]\n"
+        "                         [--mode cycle|instruction] [--rewind MB]\n"
+        "                         [--run-ahead N] [--record file]\n"
+        "                         [--play file [--seek N]] [--realtime]\n"
+        "\n"
+        "The input script holds one entry per line with the format\n"
+        "  <frame> <buttons>\n"
+        "where buttons is a '+' separated list of A, B, SELECT, START, UP,\n"
+        "DOWN, LEFT, RIGHT, or '-' to release everything. Controller #1 "
+        "keeps\n"
+        "that state until the next entry. Lines starting with '#' are "
+        "ignored.\n"
+        "\n"
+        "--rewind records every measured frame in a rewind history of the\n"
+        "given size, then rewinds it all and reports the costs.\n"
+        "\n"
+        "--record saves the input of every frame to a movie file. --play\n"
+        "replays a movie from its first frame instead of the script, and\n"
+        "--seek then jumps back to a frame of it and reports the cost.\n"
+        "\n"
+        "--realtime paces the measured frames at the NTSC frame rate and\n"
+        "reports the timing jitter and the CPU usage.\n");
+}
+
+bool ParseButtons(const std::string& text, uint8_t& buttons) {
+    buttons = 0x00;
+    if (text == "-") {
+        return true;
+    }
+    std::istringstream tokens{text};
+    std::string button;
+    while (std::getline(tokens, button, '+')) {
+        if (button == "A") {
+            buttons |= dearnes::BUTTON_A;
+        } else if (button == "B") {
+            buttons |= dearnes::BUTTON_B;
+        } else if (button == "SELECT") {
+            buttons |= dearnes::BUTTON_SELECT;
+        } else if (button == "START") {
+            buttons |= dearnes::BUTTON_START;
+        } else if (button == "UP") {
+            buttons |= dearnes::BUTTON_UP;
+        } else if (button == "DOWN") {
+            buttons |= dearnes::BUTTON_DOWN;
+        } else if (button == "LEFT") {
+            buttons |= dearnes::BUTTON_LEFT;
+        } else if (button == "RIGHT") {
+            buttons |= dearnes::BUTTON_RIGHT;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoadScript(const std::string& path, std::vector<ScriptedInput>& script) {
+    std::ifstream ifs{path};
+    if (!ifs.is_open()) {
+        fmt::print("Failed to open input script: {}\n", path);
+        return false;
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(ifs, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields{line};
+        ScriptedInput entry;
+        std::string buttons;
+        if (!(fields >> entry.m_Frame >> buttons) ||
+            !ParseButtons(buttons, entry.m_Buttons)) {
+            fmt::print("Invalid input script entry at {}:{}\n", path,
+                       lineNumber);
+            return false;
+        }
+        if (!script.empty() && entry.m_Frame < script.back().m_Frame) {
+            fmt::print("Input script entries must be sorted by frame ({}:{})\n",
+                       path, lineNumber);
+            return false;
+        }
+        script.push_back(entry);
+    }
+    return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) {
+            options.m_Frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--warmup" && hasValue) {
+            options.m_WarmupFrames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--run-ahead" && hasValue) {
+            options.m_RunAheadFrames =
+                static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--rewind" && hasValue) {
+            options.m_RewindBudget = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--record" && hasValue) {
+            options.m_RecordPath = argv[++i];
+        } else if (arg == "--play" && hasValue) {
+            options.m_PlayPath = argv[++i];
+        } else if (arg == "--seek" && hasValue) {
+            options.m_SeekFrame = std::strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "--realtime") {
+            options.m_IsRealTime = true;
+        } else if (arg == "--script" && hasValue) {
+            options.m_ScriptPath = argv[++i];
+        } else if (arg == "--mode" && hasValue) {
+            const std::string mode = argv[++i];
+            if (mode == "cycle") {
+                options.m_ExecutionMode = Nes::ExecutionMode::CYCLE_STEPPED;
+            } else if (mode == "instruction") {
+                options.m_ExecutionMode =
+                    Nes::ExecutionMode::INSTRUCTION_STEPPED;
+            } else {
+                return false;
+            }
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.m_RomPath = arg;
+        } else {
+            return false;
+        }
+    }
+    if (options.m_SeekFrame >= 0 && options.m_PlayPath.empty()) {
+        return false;
+    }
+    return options.m_Frames > 0;
+}
+
+const char* GetMovieLoaderErrorMessage(dearnes::MovieLoaderError error) {
+    switch (error) {
+        case dearnes::MovieLoaderError::FILE_NOT_FOUND:
+            return "file not found";
+        case dearnes::MovieLoaderError::VERSION_NOT_SUPPORTED:
+            return "recorded with another version of the emulator, record "
+                   "it again";
+        default:
+            return "not a valid movie for this game";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<ScriptedInput> script;
+    if (!options.m_ScriptPath.empty() &&
+        !LoadScript(options.m_ScriptPath, script)) {
+        return 1;
+    }
+
+    dearnes::CartridgeLoader cartridgeLoader;
+    auto ret = cartridgeLoader.LoadNewCartridge(options.m_RomPath);
+    if (auto error = std::get_if<dearnes::CartridgeLoaderError>(&ret)) {
+        fmt::print("Failed to load cartridge {}: {}\n", options.m_RomPath,
+                   *error == dearnes::CartridgeLoaderError::FILE_NOT_FOUND
+                       ? "file not found"
+                       : "mapper not supported");
+        return 1;
+    }
+
+    Nes* nesEmulator = new Nes();
+    nesEmulator->InsertCatridge(std::get<Cartridge*>(ret));
+    nesEmulator->SetExecutionMode(options.m_ExecutionMode);
+    nesEmulator->SetRunAheadFrames(options.m_RunAheadFrames);
+
+    dearnes::InputMovie movie;
+    if (!options.m_PlayPath.empty()) {
+        const dearnes::MovieLoaderError error =
+            movie.LoadFromFile(options.m_PlayPath, *nesEmulator);
+        if (error != dearnes::MovieLoaderError::OK) {
+            fmt::print("Failed to load movie {}: {}\n", options.m_PlayPath,
+                       GetMovieLoaderErrorMessage(error));
+            return 1;
+        }
+    }
+
+    const bool isPlaying = !options.m_PlayPath.empty();
+    const bool isRecording = !options.m_RecordPath.empty();
+    if (isPlaying && !movie.Seek(*nesEmulator, 0)) {
+        fmt::print("The movie {} was not recorded with {}\n",
+                   options.m_PlayPath, options.m_RomPath);
+        return 1;
+    }
+
+    using dearnes::CONTROLLER_PLAYER_1_IDX;
+    size_t nextInput = 0;
+    uint8_t buttons = 0x00;
+    auto RunFrame = [&](uint64_t frame) {
+        if (isPlaying) {
+            movie.PlayFrame(*nesEmulator, frame);
+        } else {
+            while (nextInput < script.size() &&
+                   script[nextInput].m_Frame <= frame) {
+                buttons = script[nextInput++].m_Buttons;
+            }
+            nesEmulator->ClearControllerState(CONTROLLER_PLAYER_1_IDX);
+            nesEmulator->WriteControllerState(CONTROLLER_PLAYER_1_IDX,
+                                              buttons);
+        }
+        if (isRecording) {
+            movie.RecordFrame(*nesEmulator);
+        }
+        nesEmulator->DoFrame();
+    };
+
+    uint64_t frame = 0;
+    for (; frame < options.m_WarmupFrames; ++frame) {
+        RunFrame(frame);
+    }
+
+    dearnes::RewindBuffer rewindBuffer{options.m_RewindBudget << 20};
+
+    dearnes::FramePacer pacer;
+    const uint64_t startTicks = nesEmulator->GetSystemClockCounter();
+    const std::clock_t startCpuTime = std::clock();
+    const auto startTime = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < options.m_Frames; ++i, ++frame) {
+        RunFrame(frame);
+        if (options.m_RewindBudget > 0) {
+            rewindBuffer.Push(*nesEmulator);
+        }
+        if (options.m_IsRealTime) {
+            pacer.WaitForNextFrame();
+        }
+    }
+    const auto endTime = std::chrono::steady_clock::now();
+    const double cpuSeconds =
+        static_cast<double>(std::clock() - startCpuTime) / CLOCKS_PER_SEC;
+    const uint64_t ticks = nesEmulator->GetSystemClockCounter() - startTicks;
+
+    const double seconds =
+        std::chrono::duration<double>(endTime - startTime).count();
+    const double fps = options.m_Frames / seconds;
+
+    fmt::print("ROM:              {}\n", options.m_RomPath);
+    fmt::print("Frames:           {} (+{} warm-up)\n", options.m_Frames,
+               options.m_WarmupFrames);
+    fmt::print("Execution mode:   {}\n",
+               options.m_ExecutionMode == Nes::ExecutionMode::CYCLE_STEPPED
+                   ? "cycle"
+                   : "instruction");
+    if (options.m_RunAheadFrames > 0) {
+        fmt::print("Run-ahead:        {} frame(s)\n", options.m_RunAheadFrames);
+    }
+    fmt::print("Wall time:        {:.3f} s\n", seconds);
+    fmt::print("Emulated FPS:     {:.2f} ({:.2f}x real time)\n", fps,
+               fps / dearnes::FramePacer::NTSC_FRAME_RATE);
+    fmt::print("Time per frame:   {:.0f} ns\n",
+               seconds * 1e9 / options.m_Frames);
+    fmt::print("Master clock:     {:.0f} ticks/s\n", ticks / seconds);
+    fmt::print("Last frame hash:  {:016X}\n",
+               nesEmulator->HashCompletedFrame());
+    if (options.m_IsRealTime) {
+        const dearnes::FramePacer::JitterStats& stats = pacer.GetJitterStats();
+        fmt::print(
+            "Frame jitter:     {:.1f} us mean, {:.1f} us std dev, {:.1f} us "
+            "max\n",
+            stats.m_MeanJitter, stats.m_StdDevJitter, stats.m_MaxJitter);
+        fmt::print("Pacing:           {:.0f} us spin margin, {} resync(s)\n",
+                   stats.m_SpinMargin, stats.m_ResyncCount);
+        fmt::print("CPU usage:        {:.1f}%\n", cpuSeconds * 100 / seconds);
+    }
+
+    if (isRecording) {
+        if (!movie.SaveToFile(options.m_RecordPath)) {
+            fmt::print("Failed to write movie: {}\n", options.m_RecordPath);
+            return 1;
+        }
+        fmt::print("Movie:            {} frames, {} keyframes, {:.1f} KB\n",
+                   movie.GetFrameCount(), movie.GetKeyframeCount(),
+                   movie.GetMemoryUsage() / 1024.0);
+    }
+
+    if (options.m_SeekFrame >= 0) {
+        const auto seekStartTime = std::chrono::steady_clock::now();
+        const bool seeked = movie.Seek(*nesEmulator, options.m_SeekFrame);
+        const double seekSeconds = std::chrono::duration<double>(
+                                       std::chrono::steady_clock::now() -
+                                       seekStartTime)
+                                       .count();
+        if (!seeked) {
+            fmt::print("Failed to seek to frame {} of {}\n",
+                       options.m_SeekFrame, movie.GetFrameCount());
+            return 1;
+        }
+        fmt::print("Seek:             frame {} in {:.2f} ms, hash {:016X}\n",
+                   options.m_SeekFrame, seekSeconds * 1e3,
+                   nesEmulator->HashCompletedFrame());
+    }
+
+    if (options.m_RewindBudget > 0) {
+        const size_t historyFrames = rewindBuffer.GetFrameCount();
+        const size_t historyBytes = rewindBuffer.GetMemoryUsage();
+        const auto rewindStartTime = std::chrono::steady_clock::now();
+        while (rewindBuffer.Rewind(*nesEmulator)) {
+        }
+        const double rewindSeconds = std::chrono::duration<double>(
+                                         std::chrono::steady_clock::now() -
+                                         rewindStartTime)
+                                         .count();
+        fmt::print("Rewind history:   {} frames in {:.2f} MB ({:.0f} B/frame)\n",
+                   historyFrames, historyBytes / 1048576.0,
+                   historyFrames > 0
+                       ? static_cast<double>(historyBytes) / historyFrames
+                       : 0.0);
+        fmt::print("Rewind step:      {:.2f} us\n",
+                   historyFrames > 0 ? rewindSeconds * 1e6 / historyFrames
+                                     : 0.0);
+    }
+
+    delete nesEmulator;
+
+    return 0;
+}
@@ -143,6 +143,10 @@ void ImGuiWindowManager::HandleEvents() {
 }
 
 void ImGuiWindowManager::Update(float deltaTime) {
+    std::unique_lock<std::mutex> lock;
+    if (m_WidgetMutex) {
+        lock = std::unique_lock<std::mutex>{*m_WidgetMutex};
+    }
     for (BaseWidget* widget : m_Widgets) {
         widget->Update(deltaTime);
     }
@@ -159,8 +163,14 @@ void ImGuiWindowManager::Render() {
 
     ShowDockSpace(&show);
 
-    for (BaseWidget* widget : m_Widgets) {
-        widget->Render();
+    {
+        std::unique_lock<std::mutex> lock;
+        if (m_WidgetMutex) {
+            lock = std::unique_lock<std::mutex>{*m_WidgetMutex};
+        }
+        for (BaseWidget* widget : m_Widgets) {
+            widget->Render();
+        }
     }
 
     // Rendering
@@ -11,12 +11,21 @@ namespace dearnes {
 class Cartridge;
 class Dma;
 class Ppu;
+class Scheduler;
+class StateReader;
+class StateWriter;
 
 /// <summary>
 /// In charge of handling memory access for the CPU and the DMA module.
 /// The CPU will be unaware from which place the memory comes from. A read
 /// or write request from the CPU can be executed in the cartridge, the PPU,
 /// the DMA (to start the transfer process), or to the controllers registers.
+///
+/// The address space is split in 1 KB pages. Pages backed by plain memory
+/// (CPU RAM and the program memory the mapper maps linearly) are accessed
+/// directly through a page table. The rest of the pages (PPU and I/O registers,
+/// banked memory) fall back to the address decoding handlers. Mappers are only
+/// expected to claim addresses from the cartridge space ($4020-$FFFF).
 /// </summary>
 class Bus {
    public:
@@ -36,7 +45,13 @@ class Bus {
     /// </summary>
     /// <param name="address">Address to write</param>
     /// <param name="data">Data to be written</param>
-    void CpuWrite(uint16_t address, uint8_t data);
+    inline void CpuWrite(uint16_t address, uint8_t data) {
+        if (uint8_t* page = m_WritePages[address >> CPU_PAGE_SHIFT]) {
+            page[address & (SIZE_CPU_PAGE - 1)] = data;
+        } else {
+            CpuWriteHandler(address, data);
+        }
+    }
 
     /// <summary>
     /// Read a byte from memory. This function follows the same rules as CpuWrite
@@ -46,7 +61,23 @@ class Bus {
     /// information on whether they can write when reading.
     /// </param>
     /// <returns>Byte from memory</returns>
-    uint8_t CpuRead(uint16_t address, bool isReadOnly = false);
+    inline uint8_t CpuRead(uint16_t address, bool isReadOnly = false) {
+        if (const uint8_t* page = m_ReadPages[address >> CPU_PAGE_SHIFT]) {
+            return page[address & (SIZE_CPU_PAGE - 1)];
+        }
+        return CpuReadHandler(address, isReadOnly);
+    }
+
+    /// <summary>
+    /// Returns a pointer to the memory that backs a whole 1 KB page of the
+    /// address space for reading, or nullptr if the page is handled by
+    /// registers or banked memory.
+    /// </summary>
+    /// <param name="page">Index of the page (address >> CPU_PAGE_SHIFT)</param>
+    /// <returns></returns>
+    inline const uint8_t* GetReadPage(uint8_t page) const {
+        return m_ReadPages[page];
+    }
 
     /// <summary>
     /// Load the current cartridge
@@ -66,6 +97,35 @@ class Bus {
     /// <param name="ppu"></param>
     void SetPpu(Ppu* ppu);
 
+    /// <summary>
+    /// Set the reference to the master clock counter. The PPU can lag behind
+    /// it: the bus brings the PPU up to date before the accesses that can see
+    /// or change its state.
+    /// </summary>
+    /// <param name="systemClockCounter"></param>
+    void SetSystemClock(const uint64_t* systemClockCounter);
+
+    /// <summary>
+    /// Set the reference to the scheduler, where the writes to $4014
+    /// schedule the ticks of the DMA transfer they start
+    /// </summary>
+    /// <param name="scheduler"></param>
+    void SetScheduler(Scheduler* scheduler);
+
+    /// <summary>
+    /// Append the CPU RAM and the controller registers to a savestate, see
+    /// Nes::SaveState
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter& writer) const;
+
+    /// <summary>
+    /// Restore the state written by SaveState. The page table is rebuilt, in
+    /// case the cartridge state has changed the mapping.
+    /// </summary>
+    /// <param name="reader"></param>
+    void LoadState(StateReader& reader);
+
     // TODO: Provide better controller API
     
     /// <summary>
@@ -103,15 +163,38 @@ class Bus {
     void WriteControllerState(size_t controllerIdx, uint8_t data);
 
    private:
+    /// <summary>
+    /// Address decoding for the pages without a direct memory pointer
+    /// </summary>
+    void CpuWriteHandler(uint16_t address, uint8_t data);
+
+    /// <summary>
+    /// Address decoding for the pages without a direct memory pointer
+    /// </summary>
+    uint8_t CpuReadHandler(uint16_t address, bool isReadOnly);
+
+    /// <summary>
+    /// Rebuild the page table. The CPU RAM is mirrored over $0000-$1FFF, and
+    /// the cartridge is asked for the pages of its address space.
+    /// </summary>
+    void UpdatePageTable();
+
+    void CatchUpPpu();
+
     Cartridge* m_Cartridge = nullptr;
     Dma* m_Dma = nullptr;
     Ppu* m_Ppu = nullptr;
+    Scheduler* m_Scheduler = nullptr;
+    const uint64_t* m_SystemClockCounter = nullptr;
 
     uint8_t m_Controllers[NUM_CONTROLLERS] = {0};
     uint8_t m_ControllerState[NUM_CONTROLLERS] = {0};
 
     std::array<uint8_t, SIZE_CPU_RAM> m_CpuRam;
 
+    std::array<const uint8_t*, NUM_CPU_PAGES> m_ReadPages;
+    std::array<uint8_t*, NUM_CPU_PAGES> m_WritePages;
+
     inline uint16_t GetRealRamAddress(uint16_t address) const {
         return address & 0x07FF;
     }
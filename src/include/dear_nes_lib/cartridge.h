@@ -2,16 +2,20 @@
 #pragma once
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "dear_nes_lib/cartridge_header.h"
+#include "dear_nes_lib/mapper_variant.h"
+#include "dear_nes_lib/rom_image.h"
 
 namespace dearnes {
 
 // Forward declarations
-class IMapper;
 class CartridgeLoader;
+class StateReader;
+class StateWriter;
 
 /// <summary>
 /// Holds the information and data from a valid NES game cartridge. This
@@ -19,15 +23,15 @@ class CartridgeLoader;
 /// It also supports only cartrigdes with mappers that the emulator has
 /// implemented. For more information about this format, refer to
 /// https://wiki.nesdev.com/w/index.php/INES.
+/// The ROM is read from a RomImage shared with the other cartridges of the
+/// same game. The first write to the program or character memory gives the
+/// cartridge its own copy of it, and games without character ROM get their
+/// own character RAM.
 /// </summary>
 class Cartridge {
    public:
 
-    Cartridge(CartridgeHeader&& header, IMapper* mapper,
-              std::vector<uint8_t>&& programMemory,
-              std::vector<uint8_t>&& characterMemory);
-
-    ~Cartridge();
+    Cartridge(std::shared_ptr<const RomImage> romImage, MapperVariant mapper);
 
     CartridgeHeader::MIRRORING_MODE GetMirroringMode() const;
 
@@ -71,12 +75,101 @@ class Cartridge {
     /// <returns></returns>
     bool PpuWrite(uint16_t address, uint8_t data);
 
+    /// <summary>
+    /// Returns a pointer to the program memory that backs a whole 1 KB page
+    /// of the CPU address space for reading, or nullptr if the mapper does
+    /// not map the page linearly.
+    /// </summary>
+    /// <param name="page"></param>
+    /// <returns></returns>
+    const uint8_t* GetCpuReadPage(uint8_t page);
+
+    /// <summary>
+    /// Same as GetCpuReadPage, for writing.
+    /// </summary>
+    /// <param name="page"></param>
+    /// <returns></returns>
+    uint8_t* GetCpuWritePage(uint8_t page);
+
+    /// <summary>
+    /// Returns a pointer to the character memory that backs a whole 1 KB page
+    /// of the PPU pattern table space for reading, or nullptr if the mapper
+    /// does not map the page linearly.
+    /// </summary>
+    /// <param name="page"></param>
+    /// <returns></returns>
+    const uint8_t* GetPpuReadPage(uint8_t page);
+
+    /// <summary>
+    /// Returns true if the mapper has changed its page mapping, or the
+    /// cartridge has copied the memory behind the pages, since the last call.
+    /// </summary>
+    /// <returns></returns>
+    bool ConsumeMappingChanged();
+
+    /// <summary>
+    /// Append the memory that the cartridge can write to and the mapper state
+    /// to a savestate, see CartridgeStateHeader and Nes::SaveState. The ROM
+    /// is only identified by its hash.
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter& writer) const;
+
+    /// <summary>
+    /// Size in bytes of the state written by SaveState. It grows when the
+    /// game first writes to the ROM, which gives the cartridge a copy of it.
+    /// </summary>
+    /// <returns></returns>
+    size_t GetStateSize() const;
+
+    /// <summary>
+    /// Size in bytes of the state once the cartridge has a copy of all its
+    /// ROM, the largest that GetStateSize can return.
+    /// </summary>
+    /// <returns></returns>
+    size_t GetMaxStateSize() const;
+
+    /// <summary>
+    /// Restore the state written by SaveState, of the given size. Returns
+    /// false, without changing anything, if it was saved with another ROM or
+    /// its memory sizes do not match this cartridge. The copies of the ROM
+    /// missing from the state are dropped, to read the ROM again.
+    /// </summary>
+    /// <param name="reader"></param>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    bool LoadState(StateReader& reader, size_t size);
+
    private:
-    CartridgeHeader m_CartridgeHeader;
+    size_t GetMapperStateSize() const;
+
+    /// <summary>
+    /// Returns the program memory for writing, copying it from the ROM image
+    /// on the first call.
+    /// </summary>
+    /// <returns></returns>
+    uint8_t* GetWritableProgramMemory();
+
+    /// <summary>
+    /// Same as GetWritableProgramMemory, for the character memory.
+    /// </summary>
+    /// <returns></returns>
+    uint8_t* GetWritableCharacterMemory();
+
+    std::shared_ptr<const RomImage> m_RomImage;
+
+    MapperVariant m_Mapper;
+
+    // Point to the memory of the ROM image until the cartridge writes to it,
+    // then to the copies below
+    const uint8_t* m_ProgramMemory = nullptr;
+    const uint8_t* m_CharacterMemory = nullptr;
+    size_t m_CharacterMemorySize = 0;
 
-    IMapper* m_Mapper = nullptr;
+    std::vector<uint8_t> m_ProgramMemoryCopy;
+    // Also holds the character RAM of the games without character ROM
+    std::vector<uint8_t> m_CharacterMemoryCopy;
 
-    std::vector<uint8_t> m_ProgramMemory;
-    std::vector<uint8_t> m_CharacterMemory;
+    bool m_MemoryCopied = false;
 };
 }  // namespace dearnes
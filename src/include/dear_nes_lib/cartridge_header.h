@@ -1,5 +1,6 @@
 // Copyright (c) 2020 Emmanuel Arias
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
 
@@ -15,6 +16,12 @@ class CartridgeHeader {
     CartridgeHeader() = delete;
     CartridgeHeader(std::ifstream& inputStream);
 
+    /// <summary>
+    /// Read the header from the first SIZE bytes of a memory buffer
+    /// </summary>
+    /// <param name="data"></param>
+    CartridgeHeader(const uint8_t* data);
+
     /// <summary>
     /// Mirroring mode for the game. Refer to
     /// https://wiki.nesdev.com/w/index.php/Mirroring
@@ -54,7 +61,19 @@ class CartridgeHeader {
         return static_cast<size_t>(m_iNesHeader.m_ChrRomChunks) * 8192;
     }
 
+    /// <summary>
+    /// Size of the header in the iNES file
+    /// </summary>
+    static constexpr size_t SIZE = 16;
+
+    /// <summary>
+    /// Size of the optional trainer that follows the header
+    /// </summary>
+    static constexpr size_t SIZE_TRAINER = 512;
+
    private:
+    void ReadMirroringMode();
+
     struct iNesHeader {
         /// <summary>
         /// Magic constant. Must be $4E $45 $53 $1A
@@ -113,6 +132,7 @@ class CartridgeHeader {
         char m_Unused[5];
     };
     iNesHeader m_iNesHeader;
+    static_assert(sizeof(iNesHeader) == SIZE, "iNES header must be 16 bytes");
 
     MIRRORING_MODE m_MirroringMode = MIRRORING_MODE::HORIZONTAL;
 
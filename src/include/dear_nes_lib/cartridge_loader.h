@@ -1,16 +1,19 @@
 // Copyright (c) 2020 Emmanuel Arias
 #pragma once
+#include <fstream>
+#include <memory>
 #include <string>
 #include <variant>
 
 #include "dear_nes_lib/enums.h"
+#include "dear_nes_lib/mapper_variant.h"
 
 namespace dearnes {
 
 // Forward declaration
 class Cartridge;
 class CartridgeHeader;
-class IMapper;
+class RomImage;
 
 class CartridgeLoader {
    public:
@@ -20,10 +23,39 @@ class CartridgeLoader {
     std::variant<CartridgeLoaderError, Cartridge*> LoadNewCartridge(
         std::ifstream& inputStream);
 
+    /// <summary>
+    /// Read an iNES file into a ROM image that can be shared by many
+    /// cartridges, see CreateCartridge. Regular files are memory mapped and
+    /// the image refers to the mapped pages, anything else is read as a
+    /// stream.
+    /// </summary>
+    /// <param name="fileName"></param>
+    /// <returns></returns>
+    std::variant<CartridgeLoaderError, std::shared_ptr<const RomImage>>
+    LoadRomImage(const std::string& fileName);
+
+    std::variant<CartridgeLoaderError, std::shared_ptr<const RomImage>>
+    LoadRomImage(std::ifstream& inputStream);
+
+    /// <summary>
+    /// Create a new cartridge that reads its ROM from the image. The mapper
+    /// of the image must be supported, which is always the case for the
+    /// images returned by LoadRomImage.
+    /// </summary>
+    /// <param name="romImage"></param>
+    /// <returns></returns>
+    Cartridge* CreateCartridge(std::shared_ptr<const RomImage> romImage);
+
    private:
     bool IsMapperSupported(uint8_t mapperId);
 
-    IMapper* CreateMapper(const CartridgeHeader& header);
+    /// <summary>
+    /// Create the mapper of a supported iNES mapper id, see
+    /// IsMapperSupported.
+    /// </summary>
+    /// <param name="header"></param>
+    /// <returns></returns>
+    MapperVariant CreateMapper(const CartridgeHeader& header);
 };
 
 }  // namespace dearnes
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "dear_nes_lib/enums.h"
+
+namespace dearnes {
+
+/// <summary>
+/// Pattern table tiles decoded into rows of 2 bit pixels, so the PPU draws a
+/// tile row with one lookup instead of combining its two bitplanes bit by
+/// bit. Each row is also kept flipped horizontally, for the sprites.
+///
+/// The tiles are decoded on first use from the memory each 1 KB page of the
+/// pattern tables maps to: the first tile used in a page decodes the whole
+/// page at once, with the SIMD kernels of DecodeTiles. Mapping another bank
+/// in a page, see SetPage, drops the tiles of that page, and writes to
+/// character RAM drop the tile they hit, see InvalidateTile, which is then
+/// decoded alone.
+/// </summary>
+class ChrTileCache {
+   public:
+    static constexpr size_t NUM_PAGES = 0x2000 / SIZE_PPU_PAGE;
+    static constexpr size_t NUM_TILES = 0x2000 / 16;
+    static constexpr size_t TILES_PER_PAGE = NUM_TILES / NUM_PAGES;
+
+    /// <summary>
+    /// The 8 rows of a tile, see DecodeTileRow
+    /// </summary>
+    struct Tile {
+        uint16_t m_Rows[8];
+        uint16_t m_FlippedRows[8];
+    };
+
+    /// <summary>
+    /// Split a row back into its two bitplanes, see DecodeTileRow
+    /// </summary>
+    static void EncodeRow(uint16_t row, uint8_t& lo, uint8_t& hi);
+
+    /// <summary>
+    /// Reverse the order of the pixels of a row
+    /// </summary>
+    static uint16_t FlipRow(uint16_t row);
+
+    /// <summary>
+    /// Set the memory a page of the pattern tables maps to. The tiles of the
+    /// page are dropped if it changed.
+    /// </summary>
+    /// <param name="page">Page of the pattern tables, 0 to 7</param>
+    /// <param name="memory">The 1 KB of the page, or nullptr if the page can
+    /// only be read through the mapper, which leaves it uncached</param>
+    void SetPage(size_t page, const uint8_t* memory);
+
+    /// <summary>
+    /// Drop the tile holding a pattern table address, after a write
+    /// </summary>
+    void InvalidateTile(uint16_t address);
+
+    /// <summary>
+    /// Drop every tile, after the memory of the pages was replaced
+    /// </summary>
+    void InvalidateAll();
+
+    /// <summary>
+    /// Tile holding a pattern table address, decoded if needed. Returns
+    /// nullptr if the page of the tile is uncached.
+    /// </summary>
+    /// <param name="address">Address of the tile or of one of its rows</param>
+    /// <returns></returns>
+    inline const Tile* GetTile(uint16_t address) {
+        const size_t tileIdx = (address & 0x1FFF) >> 4;
+        if (!m_IsTileValid[tileIdx] && !DecodeTile(tileIdx)) {
+            return nullptr;
+        }
+        return &m_Tiles[tileIdx];
+    }
+
+   private:
+    bool DecodeTile(size_t tileIdx);
+    void DecodePage(size_t pageIdx);
+
+    std::array<const uint8_t*, NUM_PAGES> m_Pages{};
+    // True for the pages whose tiles are all dropped
+    std::array<bool, NUM_PAGES> m_IsPageStale{};
+    std::array<bool, NUM_TILES> m_IsTileValid{};
+    std::array<Tile, NUM_TILES> m_Tiles;
+};
+
+}  // namespace dearnes
@@ -1,6 +1,9 @@
 // Copyright (c) 2020 Emmanuel Arias
 #pragma once
+#include <array>
 #include <cinttypes>
+#include <cstddef>
+#include <utility>
 
 #include "dear_nes_lib/enums.h"
 
@@ -8,6 +11,8 @@ namespace dearnes {
 
 // Forward declaration
 class Bus;
+class StateReader;
+class StateWriter;
 
 /// <summary>
 /// Virtual implementation of the 6502 CPU version for the NES. The instruction
@@ -20,6 +25,15 @@ class Bus;
 /// </summary>
 class Cpu {
    public:
+    /// <summary>
+    /// How Clock() runs the instruction of an op code.
+    /// INSTRUCTION_TABLE calls the addressing mode and the instruction
+    /// callbacks from the look-up table, one after the other.
+    /// FUSED calls a single handler per op code, generated from the same table,
+    /// in which the addressing mode is inlined into the instruction.
+    /// Both modes run the same code, so they produce the same results.
+    /// </summary>
+    enum class DispatchMode { INSTRUCTION_TABLE, FUSED };
 
     /// <summary>
     /// Set the reference to the memory bus
@@ -38,6 +52,18 @@ class Cpu {
     /// </summary>
     void Reset();
 
+    /// <summary>
+    /// Append the state of the CPU to a savestate, see Nes::SaveState
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter& writer) const;
+
+    /// <summary>
+    /// Restore the state written by SaveState
+    /// </summary>
+    /// <param name="reader"></param>
+    void LoadState(StateReader& reader);
+
     /// <summary>
     /// This function will read the opcode from the memory location pointed by the
     /// program counter register and execute the function. It will add the proper amount
@@ -59,6 +85,33 @@ class Cpu {
     /// <returns></returns>
     inline bool IsCurrentInstructionComplete() const { return m_Cycles == 0; }
 
+    /// <summary>
+    /// Returns how many more CPU cycles the current instruction will take
+    /// before the next one is fetched
+    /// </summary>
+    /// <returns></returns>
+    inline uint8_t GetRemainingCycles() const { return m_Cycles; }
+
+    /// <summary>
+    /// Account for CPU cycles that elapsed without calling Clock(). It is
+    /// equivalent to calling Clock() the same amount of times while the
+    /// current instruction is not complete.
+    /// </summary>
+    /// <param name="cycles">Must not be greater than GetRemainingCycles()</param>
+    inline void SkipCycles(uint8_t cycles) { m_Cycles -= cycles; }
+
+    /// <summary>
+    /// Set how Clock() runs the instructions
+    /// </summary>
+    /// <param name="mode"></param>
+    inline void SetDispatchMode(DispatchMode mode) { m_DispatchMode = mode; }
+
+    /// <summary>
+    /// Get how Clock() runs the instructions
+    /// </summary>
+    /// <returns></returns>
+    inline DispatchMode GetDispatchMode() const { return m_DispatchMode; }
+
     /// <summary>
     /// Return 0x01 or 0x01 for a given register flag
     /// </summary>
@@ -174,7 +227,14 @@ class Cpu {
     bool m_AddressingModeNeedsAdditionalCycle = false;
     bool m_InstructionNeedsAdditionalCycle = false;
 
-    static Instruction m_InstructionTable[0x100];
+    DispatchMode m_DispatchMode = DispatchMode::FUSED;
+
+    static const Instruction m_InstructionTable[0x100];
+
+    /// <summary>
+    /// One handler per op code, each one an instantiation of ExecuteOpCode
+    /// </summary>
+    static const std::array<FuncPtr, 0x100> m_FusedInstructionTable;
 
    private:
     uint8_t Read(uint16_t address);
@@ -187,6 +247,26 @@ class Cpu {
 
     constexpr const Instruction& FindInstruction(const uint8_t opCode);
 
+    /// <summary>
+    /// Run the addressing mode and the instruction of m_OpCode through the
+    /// look-up table callbacks.
+    /// </summary>
+    void ExecuteFromInstructionTable();
+
+    /// <summary>
+    /// Fused handler for a single op code. The look-up table entry is known at
+    /// compile time, so the addressing mode and the instruction callbacks are
+    /// inlined into it.
+    /// </summary>
+    template <uint8_t OpCode>
+    void ExecuteOpCode();
+
+    template <std::size_t... OpCodes>
+    static constexpr std::array<FuncPtr, 0x100> MakeFusedInstructionTable(
+        std::index_sequence<OpCodes...>) {
+        return {&Cpu::ExecuteOpCode<OpCodes>...};
+    }
+
    private:
     void AddrImmediate();
 
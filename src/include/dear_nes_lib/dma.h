@@ -6,6 +6,8 @@
 namespace dearnes {
 
 class Bus;
+class StateReader;
+class StateWriter;
 
 
 /// <summary>
@@ -56,11 +58,38 @@ class Dma {
     /// <returns></returns>
     std::pair<uint8_t, uint8_t> GetLastReadData();
 
+    /// <summary>
+    /// Return the 256 bytes to transfer when they are plain memory that can be
+    /// copied at once (CPU RAM, or the program memory the mapper maps
+    /// linearly), or nullptr if they have to be read byte by byte through the
+    /// bus. Only valid before the transfer started copying.
+    /// </summary>
+    /// <returns></returns>
+    const uint8_t* GetDirectSourcePage() const;
+
+    /// <summary>
+    /// Terminate the transfer after the page of GetDirectSourcePage was copied
+    /// at once, leaving the registers as the last byte copied would.
+    /// </summary>
+    void FinishDirectTransfer();
+
     /// <summary>
     /// Reset the DMA registers.
     /// </summary>
     void Reset();
 
+    /// <summary>
+    /// Append the state of the DMA to a savestate, see Nes::SaveState
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter& writer) const;
+
+    /// <summary>
+    /// Restore the state written by SaveState
+    /// </summary>
+    /// <param name="reader"></param>
+    void LoadState(StateReader& reader);
+
     /// <summary>
     /// Informs is there is a DMA transfer requested/in progress.
     /// </summary>
@@ -0,0 +1,145 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dear_nes_lib/rewind_buffer.h"
+#include "dear_nes_lib/spsc_queue.h"
+#include "dear_nes_lib/triple_buffer.h"
+
+namespace dearnes {
+
+// Forward declarations
+class Nes;
+
+/// <summary>
+/// Runs the emulator on its own thread, one frame per period of the NES
+/// video signal (see FramePacer), so that the frame rate does not depend on how long the user
+/// interface takes to draw.
+///
+/// The two threads do not share the emulator for the common paths: the
+/// completed frames are converted to ARGB and published through a
+/// TripleBuffer, and the controller input is sent through a SpscQueue. Code
+/// that needs to read or change the emulator directly, like the debug
+/// widgets, must hold the mutex returned by GetNesMutex, which the thread
+/// only holds while it runs a frame.
+/// </summary>
+class EmulationThread {
+   public:
+    /// <summary>
+    /// Prepare the thread, without starting it
+    /// </summary>
+    /// <param name="nes">Emulator to run. Must outlive the thread.</param>
+    /// <param name="rewindMemoryBudget">Memory of the history used to run
+    /// the emulation backwards, see SetRewinding</param>
+    EmulationThread(Nes* nes, size_t rewindMemoryBudget);
+
+    /// <summary>
+    /// Stop the thread if it is running
+    /// </summary>
+    ~EmulationThread();
+
+    EmulationThread(const EmulationThread&) = delete;
+    EmulationThread& operator=(const EmulationThread&) = delete;
+
+    void Start();
+
+    /// <summary>
+    /// Wait for the current frame to finish and stop the thread
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// Send the state of a controller, applied before the next frame. Returns
+    /// false if the thread is too far behind to take more input.
+    /// </summary>
+    /// <param name="controllerIdx"></param>
+    /// <param name="buttons">Pressed buttons, see ControllerButton</param>
+    /// <returns></returns>
+    bool SendControllerState(size_t controllerIdx, uint8_t buttons);
+
+    /// <summary>
+    /// Run or pause the emulation. While paused, the input is still applied
+    /// but no frame is emulated.
+    /// </summary>
+    /// <param name="running"></param>
+    inline void SetRunning(bool running) {
+        m_IsRunning.store(running, std::memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// While rewinding, each frame restores the state of the previous one
+    /// instead of moving forward, until the history runs out. The history
+    /// starts over when the emulator is reset or gets a new cartridge.
+    /// </summary>
+    /// <param name="rewinding"></param>
+    inline void SetRewinding(bool rewinding) {
+        m_IsRewinding.store(rewinding, std::memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// Take the newest frame published by the thread, if there is one since
+    /// the last call. Returns nullptr otherwise. The 256x240 ARGB pixels stay
+    /// valid until the next call that returns a new frame.
+    /// </summary>
+    /// <returns></returns>
+    const int* AcquireFrame();
+
+    /// <summary>
+    /// Mutex to hold while accessing the emulator from another thread
+    /// </summary>
+    /// <returns></returns>
+    inline std::mutex& GetNesMutex() { return m_NesMutex; }
+
+    /// <summary>
+    /// Number of frames emulated since the start, forward or backwards
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetFrameCount() const {
+        return m_FrameCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    struct ControllerInput {
+        uint8_t m_ControllerIdx = 0;
+        uint8_t m_Buttons = 0;
+    };
+
+    void Run();
+
+    /// <summary>
+    /// Apply the pending input and emulate one frame, forward or backwards.
+    /// Must hold m_NesMutex.
+    /// </summary>
+    void RunFrame();
+
+    /// <summary>
+    /// Convert the frame completed by the PPU, if it is a new one, into the
+    /// back buffer and publish it. Must hold m_NesMutex.
+    /// </summary>
+    void PublishFrame();
+
+    Nes* m_Nes = nullptr;
+    RewindBuffer m_RewindBuffer;
+    // Reset count of the emulator when the history was started
+    uint64_t m_RewindResetCount = 0;
+
+    std::thread m_Thread;
+    std::mutex m_NesMutex;
+    std::atomic<bool> m_IsStopRequested{false};
+    std::atomic<bool> m_IsRunning{true};
+    std::atomic<bool> m_IsRewinding{false};
+    std::atomic<uint64_t> m_FrameCount{0};
+
+    SpscQueue<ControllerInput, 64> m_InputQueue;
+
+    TripleBuffer<std::vector<int>> m_Frames;
+    // Completed frame count of the last published frame
+    uint64_t m_PublishedFrameCount = 0;
+};
+
+}  // namespace dearnes
@@ -18,14 +18,50 @@ enum CpuFlag : uint8_t {
 
 static constexpr size_t SIZE_CPU_RAM = 0x0800;
 
+// Character RAM of the cartridges without character ROM
+static constexpr size_t SIZE_CHR_RAM = 0x2000;
+
+// The CPU address space is split in 1 KB pages for the bus memory map
+static constexpr size_t SIZE_CPU_PAGE = 0x0400;
+static constexpr size_t NUM_CPU_PAGES = 0x10000 / SIZE_CPU_PAGE;
+static constexpr uint8_t CPU_PAGE_SHIFT = 10;
+
+// Same for the PPU address space, used by the PPU memory map
+static constexpr size_t SIZE_PPU_PAGE = 0x0400;
+static constexpr size_t NUM_PPU_PAGES = 0x4000 / SIZE_PPU_PAGE;
+static constexpr uint8_t PPU_PAGE_SHIFT = 10;
+
 static constexpr size_t NUM_CONTROLLERS = 2;
 static constexpr size_t CONTROLLER_PLAYER_1_IDX = 0;
 static constexpr size_t CONTROLLER_PLAYER_2_IDX = 1;
 
+/// <summary>
+/// Bit masks for the buttons of a standard controller, as they are laid out
+/// in the controller register. The button in the MSB is the first one to be
+/// shifted out when the CPU reads $4016/$4017.
+/// </summary>
+enum ControllerButton : uint8_t {
+    BUTTON_A = 0x80,
+    BUTTON_B = 0x40,
+    BUTTON_SELECT = 0x20,
+    BUTTON_START = 0x10,
+    BUTTON_UP = 0x08,
+    BUTTON_DOWN = 0x04,
+    BUTTON_LEFT = 0x02,
+    BUTTON_RIGHT = 0x01
+};
+
 enum class CartridgeLoaderError {
     FILE_NOT_FOUND,
     MAPPER_NOT_SUPPORTED,
     OK
 };
 
+enum class MovieLoaderError {
+    FILE_NOT_FOUND,
+    VERSION_NOT_SUPPORTED,
+    INVALID_MOVIE,
+    OK
+};
+
 }  // namespace dearnes
\ No newline at end of file
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace dearnes {
+
+/// <summary>
+/// Waits for the start of each frame of a loop running at a fixed rate,
+/// without burning a core. The thread sleeps until shortly before the
+/// deadline and only spins for the rest, since sleeps are only accurate to a
+/// fraction of a millisecond. The spin margin adapts to how late the sleeps
+/// of this machine actually wake up.
+///
+/// The deadlines are computed from the start of the loop and the frame
+/// number, not by adding periods, so the rounding of the period never
+/// accumulates and the average rate is exact.
+/// </summary>
+class FramePacer {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /// <summary>
+    /// Frames per second of the NTSC NES
+    /// </summary>
+    static constexpr double NTSC_FRAME_RATE = 60.0988;
+
+    /// <summary>
+    /// How late the frames started, in microseconds
+    /// </summary>
+    struct JitterStats {
+        uint64_t m_FrameCount = 0;
+        double m_MeanJitter = 0.0;
+        double m_StdDevJitter = 0.0;
+        double m_MaxJitter = 0.0;
+        // Number of times the loop fell too far behind and the deadlines
+        // were restarted from the current time
+        uint64_t m_ResyncCount = 0;
+        // Current time spent spinning before each deadline
+        double m_SpinMargin = 0.0;
+    };
+
+    /// <summary>
+    /// Start pacing from now: the first frame is due one period later
+    /// </summary>
+    /// <param name="frameRate">Frames per second</param>
+    explicit FramePacer(double frameRate = NTSC_FRAME_RATE);
+
+    /// <summary>
+    /// Restart the deadlines from now, for instance after a pause
+    /// </summary>
+    void Reset();
+
+    /// <summary>
+    /// Block until the start of the next frame. When the loop is running
+    /// late it returns at once, and the next frames run back to back to
+    /// catch up, unless it is more than a few frames behind: the deadlines
+    /// are then restarted instead.
+    /// </summary>
+    void WaitForNextFrame();
+
+    inline const JitterStats& GetJitterStats() const { return m_Stats; }
+
+    void ResetJitterStats();
+
+   private:
+    Clock::time_point GetDeadline(uint64_t frameIdx) const;
+
+    void RecordJitter(Clock::duration lateness);
+
+    double m_FramePeriodNs = 0.0;
+    Clock::time_point m_Start;
+    // Frame whose start WaitForNextFrame waits for
+    uint64_t m_NextFrameIdx = 1;
+
+    // Running estimate of how late the sleeps wake up, see the spin margin
+    // constants in the source
+    double m_OversleepNs = 0.0;
+    Clock::duration m_SpinMargin;
+
+    JitterStats m_Stats;
+    double m_JitterSum = 0.0;
+    double m_JitterSquareSum = 0.0;
+};
+
+}  // namespace dearnes
@@ -0,0 +1,177 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dear_nes_lib/enums.h"
+
+namespace dearnes {
+
+// Forward declarations
+class Nes;
+
+/// <summary>
+/// Recording of the controller input of a play session. Given the same
+/// starting state and the same input, the emulation always produces the same
+/// frames, so one byte per controller per frame is enough to replay it.
+///
+/// Every keyframeInterval frames the state of the machine is embedded in the
+/// movie, so that playback can start from any frame: Seek restores the last
+/// keyframe before the frame and fast-forwards to it, drawing only the frame
+/// right before it. The first keyframe is the starting state of the movie;
+/// the next ones are stored as a delta with the previous keyframe, see
+/// state_delta.h.
+/// </summary>
+class InputMovie {
+   public:
+    /// <summary>
+    /// Create an empty movie.
+    /// </summary>
+    /// <param name="keyframeInterval">Number of frames between two embedded
+    /// states. Shorter intervals make Seek faster, at the cost of a larger
+    /// movie.</param>
+    explicit InputMovie(uint32_t keyframeInterval = 300);
+
+    /// <summary>
+    /// Drop every frame and keyframe
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Append the controller state of the emulator as the input of the next
+    /// frame. Call it once per frame, after writing the input and before
+    /// running the frame with DoFrame. The state of the machine is embedded
+    /// in the movie on the first frame and every keyframeInterval frames.
+    /// Returns false if the state can not be saved.
+    /// </summary>
+    /// <param name="nes"></param>
+    /// <returns></returns>
+    bool RecordFrame(const Nes& nes);
+
+    /// <summary>
+    /// Write the recorded input of a frame to the controllers of the
+    /// emulator, to run that frame with DoFrame. Returns false, leaving the
+    /// controllers untouched, if the movie does not reach that frame.
+    /// </summary>
+    /// <param name="nes"></param>
+    /// <param name="frame"></param>
+    /// <returns></returns>
+    bool PlayFrame(Nes& nes, uint64_t frame) const;
+
+    /// <summary>
+    /// Bring the emulator to the state it had right before running the given
+    /// frame of the movie. The last keyframe strictly before it is restored,
+    /// and the frames in between are replayed with rendering disabled, except
+    /// the last one so that the output screen is up to date. Seek(nes, 0)
+    /// restores the starting state and blanks the screen, to play the movie
+    /// from the beginning.
+    /// Returns false if the frame is past the end of the movie or the
+    /// emulator is running another game.
+    /// </summary>
+    /// <param name="nes"></param>
+    /// <param name="frame"></param>
+    /// <returns></returns>
+    bool Seek(Nes& nes, uint64_t frame);
+
+    /// <summary>
+    /// Drop the frames from the given one onwards, to record a different
+    /// input from there. Usually called after a Seek to the same frame.
+    /// </summary>
+    /// <param name="frame"></param>
+    void Truncate(uint64_t frame);
+
+    /// <summary>
+    /// Write the movie to a file. Returns false if the file can not be
+    /// written.
+    /// </summary>
+    /// <param name="fileName"></param>
+    /// <returns></returns>
+    bool SaveToFile(const std::string& fileName) const;
+
+    /// <summary>
+    /// Replace the movie with the contents of a file written by SaveToFile.
+    /// On error the movie is left empty. Movies of another version of the
+    /// format, which changes with the savestate format, are rejected with
+    /// VERSION_NOT_SUPPORTED.
+    /// </summary>
+    /// <param name="fileName"></param>
+    /// <param name="nes">Emulator running the game of the movie</param>
+    /// <returns></returns>
+    MovieLoaderError LoadFromFile(const std::string& fileName,
+                                  const Nes& nes);
+
+    /// <summary>
+    /// Number of recorded frames
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetFrameCount() const {
+        return m_Input.size() / NUM_CONTROLLERS;
+    }
+
+    /// <summary>
+    /// Recorded state of a controller for a frame before GetFrameCount()
+    /// </summary>
+    /// <param name="frame"></param>
+    /// <param name="controllerIdx"></param>
+    /// <returns></returns>
+    inline uint8_t GetInput(uint64_t frame, size_t controllerIdx) const {
+        return m_Input[frame * NUM_CONTROLLERS + controllerIdx];
+    }
+
+    inline size_t GetKeyframeCount() const { return m_Keyframes.size(); }
+
+    inline uint32_t GetKeyframeInterval() const { return m_KeyframeInterval; }
+
+    /// <summary>
+    /// Bytes used by the input and the embedded states, about the size of the
+    /// movie file
+    /// </summary>
+    /// <returns></returns>
+    inline size_t GetMemoryUsage() const {
+        return m_Input.size() + m_KeyframeData.size();
+    }
+
+   private:
+    struct Keyframe {
+        size_t m_Offset = 0;
+        size_t m_Size = 0;
+        // False for the keyframes stored whole, which is always the case of
+        // the first one
+        bool m_IsDelta = false;
+    };
+
+    /// <summary>
+    /// Rebuild in m_DecodedState the full state of a keyframe. Starts from
+    /// the last decoded keyframe when it comes before, so seeking forward or
+    /// recording only decodes the new keyframes.
+    /// </summary>
+    void DecodeKeyframe(size_t keyframeIdx);
+
+    /// <summary>
+    /// Set m_StateSize and size the state buffers for it
+    /// </summary>
+    void ResizeStates(size_t stateSize);
+
+    uint32_t m_KeyframeInterval = 300;
+
+    // NUM_CONTROLLERS bytes per frame
+    std::vector<uint8_t> m_Input;
+
+    std::vector<Keyframe> m_Keyframes;
+    std::vector<uint8_t> m_KeyframeData;
+    // Size of the largest keyframe. The smaller ones are padded with zeros
+    // to it when decoded, and the deltas are encoded on padded states.
+    size_t m_StateSize = 0;
+
+    // Full state of keyframe m_DecodedKeyframeIdx, when it is valid, and
+    // scratch space for a new keyframe and its delta
+    std::vector<uint8_t> m_DecodedState;
+    size_t m_DecodedKeyframeIdx = 0;
+    bool m_IsDecodedStateValid = false;
+    std::vector<uint8_t> m_NewState;
+    std::vector<uint8_t> m_Delta;
+};
+
+}  // namespace dearnes
@@ -0,0 +1,41 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace dearnes {
+
+/// <summary>
+/// Read-only memory mapping of a whole file. The pages are shared with the
+/// OS page cache, so reading a file this way does not copy it to the heap.
+/// </summary>
+class MappedFile {
+   public:
+    /// <summary>
+    /// Map a file into memory. Returns nullptr if the file does not exist, is
+    /// not a regular file (pipes, devices...), is empty, or cannot be mapped;
+    /// the caller should fall back to reading it as a stream.
+    /// </summary>
+    /// <param name="fileName"></param>
+    /// <returns></returns>
+    static std::unique_ptr<MappedFile> Open(const std::string& fileName);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline const uint8_t* GetData() const { return m_Data; }
+
+    inline size_t GetSize() const { return m_Size; }
+
+   private:
+    MappedFile(const uint8_t* data, size_t size);
+
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+}  // namespace dearnes
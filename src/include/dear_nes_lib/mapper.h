@@ -5,12 +5,22 @@
 
 namespace dearnes {
 
+// Forward declarations
+class StateReader;
+class StateWriter;
+
 /// <summary>
-/// Interface class for iNES mapper implementation. Each implementation will define
-/// the memory address that belongs to it. This class might be reworked in the future
-/// to avoid having virtual functions.
+/// Base class for iNES mapper implementation. Each implementation will define
+/// the memory address that belongs to it, hiding the functions below that it
+/// needs to change. CpuMapRead, CpuMapWrite, PpuMapRead and PpuMapWrite are
+/// only declared here and every mapper must define them. There are no
+/// virtual functions: the cartridge holds its mapper in a MapperVariant and
+/// the calls are resolved at compile time. The page mapping functions are
+/// only called when the mapping changes: the bus and the PPU keep page tables
+/// built from them, so the per-access functions are left for the pages that
+/// are not mapped linearly.
 /// </summary>
-class IMapper {
+class MapperBase {
    public:
     /// <summary>
     /// Constructor for the mapper. Bank quantity is required, though this\
@@ -18,9 +28,7 @@ class IMapper {
     /// </summary>
     /// <param name="prgBanks"></param>
     /// <param name="chrBanks"></param>
-    IMapper(uint8_t prgBanks, uint8_t chrBanks);
-
-    virtual ~IMapper() = default;
+    MapperBase(uint8_t prgBanks, uint8_t chrBanks);
 
     /// <summary>
     /// Handle CPU read request, if the address to read belongs to the mapper domain,
@@ -29,7 +37,7 @@ class IMapper {
     /// <param name="addr"></param>
     /// <param name="mappedAddr"></param>
     /// <returns></returns>
-    virtual bool CpuMapRead(uint16_t addr, uint32_t &mappedAddr) = 0;
+    bool CpuMapRead(uint16_t addr, uint32_t &mappedAddr);
 
     /// <summary>
     /// Handle CPU write request, if the address to read belongs to the mapper
@@ -38,7 +46,7 @@ class IMapper {
     /// <param name="addr"></param>
     /// <param name="mappedAddr"></param>
     /// <returns></returns>
-    virtual bool CpuMapWrite(uint16_t addr, uint32_t &mappedAddr) = 0;
+    bool CpuMapWrite(uint16_t addr, uint32_t &mappedAddr);
 
     /// <summary>
     /// Handle PPU read request, if the address to read belongs to the mapper
@@ -48,7 +56,7 @@ class IMapper {
     /// <param name="addr"></param>
     /// <param name="mappedAddr"></param>
     /// <returns></returns>
-    virtual bool PpuMapRead(uint16_t addr, uint32_t &mappedAddr) = 0;
+    bool PpuMapRead(uint16_t addr, uint32_t &mappedAddr);
 
     /// <summary>
     /// Handle PPU write request, if the address to read belongs to the mapper
@@ -57,7 +65,64 @@ class IMapper {
     /// <param name="addr"></param>
     /// <param name="mappedAddr"></param>
     /// <returns></returns>
-    virtual bool PpuMapWrite(uint16_t addr, uint32_t &mappedAddr) = 0;
+    bool PpuMapWrite(uint16_t addr, uint32_t &mappedAddr);
+
+    /// <summary>
+    /// Handle a request to map a whole 1 KB page of the CPU address space for
+    /// reading. If every address of the page is mapped, in order, to the
+    /// program memory, save the mapped address of the first byte of the page
+    /// and return true. Otherwise return false, and the reads from the page
+    /// will go through CpuMapRead.
+    /// </summary>
+    /// <param name="page">Page index, the address of its first byte divided
+    /// by SIZE_CPU_PAGE</param>
+    /// <param name="mappedAddr"></param>
+    /// <returns></returns>
+    bool CpuMapReadPage(uint8_t page, uint32_t &mappedAddr);
+
+    /// <summary>
+    /// Same as CpuMapReadPage, for writing to the program memory.
+    /// </summary>
+    /// <param name="page"></param>
+    /// <param name="mappedAddr"></param>
+    /// <returns></returns>
+    bool CpuMapWritePage(uint8_t page, uint32_t &mappedAddr);
+
+    /// <summary>
+    /// Handle a request to map a whole 1 KB page of the PPU pattern table
+    /// space ($0000-$1FFF) for reading. If every address of the page is
+    /// mapped, in order, to the character memory, save the mapped address of
+    /// the first byte of the page and return true. Otherwise return false, and
+    /// the reads from the page will go through PpuMapRead.
+    /// </summary>
+    /// <param name="page">Page index, the address of its first byte divided
+    /// by SIZE_PPU_PAGE</param>
+    /// <param name="mappedAddr"></param>
+    /// <returns></returns>
+    bool PpuMapReadPage(uint8_t page, uint32_t &mappedAddr);
+
+    /// <summary>
+    /// Returns true if the CPU or PPU page mapping has changed since the last
+    /// call, for example after a bank switch. The bus and the PPU will then
+    /// ask again for the mapping of every page.
+    /// </summary>
+    /// <returns></returns>
+    bool ConsumeMappingChanged();
+
+    /// <summary>
+    /// Append the registers of the mapper (selected banks...) to a savestate.
+    /// Mappers without registers write nothing. The size of the state must
+    /// not change during the life of the mapper.
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter &writer) const;
+
+    /// <summary>
+    /// Restore the state written by SaveState. Mappers must set
+    /// m_MappingChanged if the page mapping changes.
+    /// </summary>
+    /// <param name="reader"></param>
+    void LoadState(StateReader &reader);
 
    protected:
     /// <summary>
@@ -69,5 +134,11 @@ class IMapper {
     /// Number of character memory banks
     /// </summary>
     uint8_t m_ChrBanks = 0;
+
+    /// <summary>
+    /// Mappers with bank switching must set this flag whenever the result of
+    /// CpuMapReadPage, CpuMapWritePage or PpuMapReadPage changes.
+    /// </summary>
+    bool m_MappingChanged = false;
 };
 }  // namespace dearnes
@@ -12,7 +12,7 @@ namespace dearnes {
 /// There is no banking switching in this format. For more info refer to:
 /// https://wiki.nesdev.com/w/index.php/NROM
 /// </summary>
-class Mapper_000 : public IMapper {
+class Mapper_000 : public MapperBase {
    public:
 
     /// <summary>
@@ -22,9 +22,11 @@ class Mapper_000 : public IMapper {
     /// <param name="chrBanks"></param>
     Mapper_000(uint8_t prgBanks, uint8_t chrBanks);
 
-    bool CpuMapRead(uint16_t addr, uint32_t &mappedAddr) override;
-    bool CpuMapWrite(uint16_t addr, uint32_t &mappedAddr) override;
-    bool PpuMapRead(uint16_t addr, uint32_t &mappedAddr) override;
-    bool PpuMapWrite(uint16_t addr, uint32_t &mappedAddr) override;
+    bool CpuMapRead(uint16_t addr, uint32_t &mappedAddr);
+    bool CpuMapWrite(uint16_t addr, uint32_t &mappedAddr);
+    bool PpuMapRead(uint16_t addr, uint32_t &mappedAddr);
+    bool PpuMapWrite(uint16_t addr, uint32_t &mappedAddr);
+    bool CpuMapReadPage(uint8_t page, uint32_t &mappedAddr);
+    bool PpuMapReadPage(uint8_t page, uint32_t &mappedAddr);
 };
 }  // namespace dearnes
@@ -0,0 +1,15 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <variant>
+
+#include "dear_nes_lib/mapper_000.h"
+
+namespace dearnes {
+
+/// <summary>
+/// One of the mappers implemented by the emulator. New mappers must be added
+/// here, and created by CartridgeLoader::CreateMapper.
+/// </summary>
+using MapperVariant = std::variant<Mapper_000>;
+
+}  // namespace dearnes
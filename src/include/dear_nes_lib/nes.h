@@ -1,20 +1,37 @@
 // Copyright (c) 2020 Emmanuel Arias
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "dear_nes_lib/bus.h"
 #include "dear_nes_lib/cpu.h"
 #include "dear_nes_lib/dma.h"
 #include "dear_nes_lib/ppu.h"
+#include "dear_nes_lib/scheduler.h"
 
 namespace dearnes {
 
 // Forward declarations
 class Cartridge;
+class StateWriter;
 
 class Nes {
    public:
+    /// <summary>
+    /// Strategy used by DoFrame() to advance the emulation.
+    /// CYCLE_STEPPED calls Clock() for every master clock tick.
+    /// INSTRUCTION_STEPPED runs the CPU one instruction at a time, ahead of
+    /// the PPU, and skips the ticks where the CPU is waiting for an
+    /// instruction to finish. The PPU is only run forward, in one loop, when
+    /// the CPU accesses it, and on the ticks of the events of the scheduler:
+    /// the PPU raising a NMI or completing the frame, and the DMA transfers.
+    /// Clock() is only called on those ticks. Both modes produce the same
+    /// results.
+    /// </summary>
+    enum class ExecutionMode { CYCLE_STEPPED, INSTRUCTION_STEPPED };
+
     /// <summary>
     /// Constructs a new NES instance
     /// </summary>
@@ -50,10 +67,74 @@ class Nes {
     void Clock();
 
     /// <summary>
-    /// Tick the emulator until a frame is completed.
+    /// Tick the emulator until a frame is completed. With run-ahead enabled,
+    /// the output screen shows the frame that comes that many frames later,
+    /// see SetRunAheadFrames.
     /// </summary>
     void DoFrame();
 
+    /// <summary>
+    /// Set the number of frames to run ahead, 0 to disable it. Games react to
+    /// the input one or more frames after reading it. With run-ahead, every
+    /// DoFrame advances the emulation one frame, without drawing it, and
+    /// saves the state. It then runs the given number of frames with the same
+    /// input, draws only the last one, and restores the saved state. The
+    /// output screen shows the effect of the input that many frames sooner, at
+    /// the cost of emulating that many extra frames.
+    /// </summary>
+    /// <param name="frames"></param>
+    void SetRunAheadFrames(uint32_t frames);
+
+    inline uint32_t GetRunAheadFrames() const { return m_RunAheadFrames; }
+
+    /// <summary>
+    /// Set the strategy used by DoFrame()
+    /// </summary>
+    /// <param name="mode"></param>
+    void SetExecutionMode(ExecutionMode mode);
+
+    /// <summary>
+    /// Get the strategy used by DoFrame()
+    /// </summary>
+    /// <returns></returns>
+    ExecutionMode GetExecutionMode() const;
+
+    /// <summary>
+    /// Returns the size in bytes of a savestate of this instance. It depends
+    /// on the inserted cartridge, and only changes while it runs the first
+    /// time the game writes to its ROM, see Cartridge::GetStateSize.
+    /// </summary>
+    /// <returns></returns>
+    size_t GetStateSize() const;
+
+    /// <summary>
+    /// Returns the largest size that GetStateSize() can return with the
+    /// inserted cartridge.
+    /// </summary>
+    /// <returns></returns>
+    size_t GetMaxStateSize() const;
+
+    /// <summary>
+    /// Write a snapshot of the whole machine into the buffer, see
+    /// save_state.h for the layout. It does not allocate memory. The
+    /// execution mode and the output screen are not part of the state.
+    /// Returns false if the buffer is smaller than GetStateSize().
+    /// </summary>
+    /// <param name="buffer"></param>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    bool SaveState(uint8_t* buffer, size_t size) const;
+
+    /// <summary>
+    /// Restore a snapshot written by SaveState from an instance running the
+    /// same game. Returns false, without changing the machine, if the buffer
+    /// is not a savestate of the current format for this cartridge.
+    /// </summary>
+    /// <param name="buffer"></param>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    bool LoadState(const uint8_t* buffer, size_t size);
+
     /// <summary>
     /// Verify that a cartridge has been fully loaded. This will be rework into
     /// a better pattern.
@@ -97,6 +178,50 @@ class Nes {
     /// controller state</param>
     void WriteControllerState(size_t controllerIdx, uint8_t data);
 
+    /// <summary>
+    /// Returns the last completed frame, in ARGB format. The buffer is not
+    /// copied: it stays valid and unchanged until the next frame is
+    /// completed, while the PPU draws into another one. See
+    /// Ppu::GetOutputScreen.
+    /// </summary>
+    /// <returns></returns>
+    inline const int* GetCompletedFrame() const {
+        return m_Ppu.GetOutputScreen();
+    }
+
+    /// <summary>
+    /// Returns the last completed frame as palette indices, with the same
+    /// lifetime as GetCompletedFrame. See Ppu::GetIndexedScreen.
+    /// </summary>
+    /// <returns></returns>
+    inline const uint16_t* GetCompletedIndexedFrame() const {
+        return m_Ppu.GetIndexedScreen();
+    }
+
+    /// <summary>
+    /// Number of frames completed so far. A consumer can compare it with the
+    /// value of its last read to know if there is a new frame.
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetCompletedFrameCount() const {
+        return m_Ppu.GetCompletedFrameCount();
+    }
+
+    /// <summary>
+    /// FNV-1a hash of the last completed frame, in ARGB format. Used to
+    /// check that two runs rendered the same frame.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t HashCompletedFrame() const;
+
+    /// <summary>
+    /// Number of resets so far, including the one done by InsertCatridge. A
+    /// consumer can compare it with the value of its last read to know if
+    /// the emulator started over, like GetCompletedFrameCount.
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetResetCount() const { return m_ResetCount; }
+
     /// <summary>
     /// Returns a pointer to the PPU module
     /// </summary>
@@ -110,6 +235,55 @@ class Nes {
     inline Cpu* GetCpu() { return &m_Cpu; }
 
    private:
+    /// <summary>
+    /// Advance the master clock through the ticks in which the CPU is only
+    /// waiting for the current instruction to complete, without running the
+    /// PPU. Stops at the next instruction, or at the given PPU event tick if
+    /// it comes first. Must not be called during a DMA transfer.
+    /// </summary>
+    /// <param name="eventTick">See Scheduler::GetNextTimestamp</param>
+    void SkipIdleTicks(uint64_t eventTick);
+
+    /// <summary>
+    /// Run a whole OAM DMA transfer at once from its first CPU tick: the page
+    /// is copied with a single write to the OAM, and the master clock jumps
+    /// over the CPU cycles stalled by the transfer. The PPU catches up
+    /// later. Returns false, doing nothing, if the page has to be read
+    /// through the bus, or if another event or the PPU reading the OAM comes
+    /// before the transfer ends.
+    /// </summary>
+    /// <returns></returns>
+    bool DoDirectDmaTransfer();
+
+    /// <summary>
+    /// Schedule the upcoming events from the state of the components, at the
+    /// start of a frame in instruction-stepped mode
+    /// </summary>
+    void ScheduleEvents();
+
+    /// <summary>
+    /// Handle the events scheduled on the current tick, and schedule the
+    /// events that follow them
+    /// </summary>
+    void RunEventTick();
+
+    /// <summary>
+    /// Emulate a single frame, see DoFrame
+    /// </summary>
+    void RunFrame();
+
+    /// <summary>
+    /// DoFrame with run-ahead enabled
+    /// </summary>
+    void RunAheadFrame();
+
+    /// <summary>
+    /// Write every section of the savestate, in order
+    /// </summary>
+    /// <param name="writer"></param>
+    /// <param name="stateSize">Value of the size field of the header</param>
+    void WriteState(StateWriter& writer, uint32_t stateSize) const;
+
     Bus m_Bus;
     Dma m_Dma;
     Ppu m_Ppu;
@@ -119,6 +293,18 @@ class Nes {
 
     bool m_IsCartridgeLoaded = false;
 
-    uint32_t m_SystemClockCounter = 0;
+    uint64_t m_ResetCount = 0;
+
+    uint64_t m_SystemClockCounter = 0;
+    // Tick where the CPU runs its next cycle, the next multiple of three
+    uint64_t m_NextCpuTick = 0;
+
+    Scheduler m_Scheduler;
+
+    ExecutionMode m_ExecutionMode = ExecutionMode::INSTRUCTION_STEPPED;
+
+    uint32_t m_RunAheadFrames = 0;
+    // State saved before running ahead, reused from frame to frame
+    std::vector<uint8_t> m_RunAheadState;
 };
 }  // namespace dearnes
\ No newline at end of file
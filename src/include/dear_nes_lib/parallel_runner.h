@@ -0,0 +1,100 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "dear_nes_lib/enums.h"
+#include "dear_nes_lib/work_stealing_pool.h"
+
+namespace dearnes {
+
+// Forward declarations
+class Nes;
+
+/// <summary>
+/// Description of a single emulator instance run by the ParallelRunner
+/// </summary>
+struct EmulationJob {
+    std::string m_RomPath;
+    uint64_t m_Frames = 0;
+    /// <summary>
+    /// State of controller #1 for each frame. When the job runs for more
+    /// frames than there are entries, the last entry is held. Empty means no
+    /// buttons pressed.
+    /// </summary>
+    std::vector<uint8_t> m_ControllerInput;
+};
+
+/// <summary>
+/// Outcome of a single emulator instance
+/// </summary>
+struct EmulationResult {
+    bool m_Success = false;
+    CartridgeLoaderError m_Error = CartridgeLoaderError::FILE_NOT_FOUND;
+    uint64_t m_FramesRun = 0;
+    uint32_t m_Batches = 0;
+    /// <summary>
+    /// Time spent by the workers running this instance, without the time it
+    /// spent waiting in the queues
+    /// </summary>
+    double m_BusySeconds = 0.0;
+};
+
+/// <summary>
+/// Aggregated outcome of ParallelRunner::Run
+/// </summary>
+struct ParallelRunSummary {
+    std::vector<EmulationResult> m_Results;
+    uint64_t m_TotalFrames = 0;
+    double m_WallSeconds = 0.0;
+};
+
+/// <summary>
+/// Runs many independent NES instances on a WorkStealingPool. The scheduling
+/// unit is a batch of frames of one instance: when a batch is done, the
+/// instance queues its next batch on the same worker, where it stays unless
+/// an idle worker steals it. The instances do not share any state, so they
+/// only need to be synchronized at batch boundaries. Each ROM is loaded once
+/// and its image is shared by all the instances that run it.
+/// </summary>
+class ParallelRunner {
+   public:
+    /// <summary>
+    /// Called from a worker thread when an instance has run all its frames,
+    /// right before it is destroyed. Useful to grab the last frame or the
+    /// state of the instance.
+    /// </summary>
+    using FinishedCallback = std::function<void(size_t jobIdx, Nes& nes)>;
+
+    /// <summary>
+    /// Create the runner and its worker threads
+    /// </summary>
+    /// <param name="numThreads">Number of worker threads</param>
+    /// <param name="framesPerBatch">Frames run by each task</param>
+    ParallelRunner(size_t numThreads, uint64_t framesPerBatch);
+
+    /// <summary>
+    /// Run every job to completion and block until all of them are done
+    /// </summary>
+    /// <param name="jobs"></param>
+    /// <param name="onFinished">Optional, see FinishedCallback</param>
+    /// <returns>One result per job, in the same order</returns>
+    ParallelRunSummary Run(const std::vector<EmulationJob>& jobs,
+                           const FinishedCallback& onFinished = nullptr);
+
+    inline size_t GetThreadCount() const { return m_Pool.GetThreadCount(); }
+
+    inline uint64_t GetFramesPerBatch() const { return m_FramesPerBatch; }
+
+   private:
+    struct Instance;
+
+    void RunBatch(Instance& instance);
+
+    WorkStealingPool m_Pool;
+    uint64_t m_FramesPerBatch;
+};
+
+}  // namespace dearnes
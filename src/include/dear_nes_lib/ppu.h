@@ -3,11 +3,16 @@
 #include <array>
 #include <cstdint>
 
+#include "dear_nes_lib/chr_tile_cache.h"
+#include "dear_nes_lib/enums.h"
+
 namespace dearnes {
 
 // Forward declaration
 class Cartridge;
 class Sprite;
+class StateReader;
+class StateWriter;
 
 /// <summary>
 /// This struct makes the extraction of bit flags from a byte register easier.
@@ -165,11 +170,83 @@ class Ppu {
     /// <param name="cartridge"></param>
     void ConnectCatridge(Cartridge* cartridge);
 
+    /// <summary>
+    /// Rebuild the table of 1 KB pages used by PpuRead. Pattern table pages
+    /// point to the cartridge character memory when the mapper maps them
+    /// linearly, and nametable pages point to the nametable selected by the
+    /// cartridge mirroring mode. This needs to be called if the cartridge
+    /// mapping changes.
+    /// </summary>
+    void UpdatePageTable();
+
+    /// <summary>
+    /// Append the state of the PPU to a savestate, see Nes::SaveState. The
+    /// output screen is not part of it: it is fully drawn again by the next
+    /// frame.
+    /// </summary>
+    /// <param name="writer"></param>
+    void SaveState(StateWriter& writer) const;
+
+    /// <summary>
+    /// Restore the state written by SaveState, and rebuild the page table
+    /// </summary>
+    /// <param name="reader"></param>
+    void LoadState(StateReader& reader);
+
     /// <summary>
     /// Perform a tick PPU routine.
     /// </summary>
     void Clock();
 
+    /// <summary>
+    /// Run the PPU forward until its timestamp reaches the given one. Does
+    /// nothing if it is already there, or one tick ahead: within a master
+    /// clock tick the PPU runs before the CPU.
+    ///
+    /// Since nothing else can access the PPU until it is caught up, the
+    /// visible part of the scanlines fully covered by the catch up is drawn
+    /// a whole scanline at a time, see RenderScanline.
+    /// </summary>
+    /// <param name="timestamp"></param>
+    void CatchUp(uint64_t timestamp);
+
+    /// <summary>
+    /// Master clock timestamp the PPU has run up to, that is the timestamp of
+    /// its next tick. Every Clock() advances it by one.
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetTimestamp() const { return m_Timestamp; }
+
+    /// <summary>
+    /// Set the timestamp of the next tick, after the master clock was reset
+    /// or restored from a savestate. It does not move the PPU.
+    /// </summary>
+    /// <param name="timestamp"></param>
+    inline void SetTimestamp(uint64_t timestamp) { m_Timestamp = timestamp; }
+
+    /// <summary>
+    /// Timestamp of the next tick that starts the vertical blank, raising a
+    /// NMI if enabled. With the end of the frame, see
+    /// GetNextFrameEndTimestamp, those are the only ticks where the PPU acts
+    /// on the CPU by itself; everything else is seen through its registers.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t GetNextVerticalBlankTimestamp() const;
+
+    /// <summary>
+    /// Timestamp of the next tick that completes the frame
+    /// </summary>
+    /// <returns></returns>
+    uint64_t GetNextFrameEndTimestamp() const;
+
+    /// <summary>
+    /// Timestamp of the next tick that reads the OAM by itself, to evaluate
+    /// the sprites of the next scanline. The OAM can be written at once
+    /// until then, see Nes::DoDirectDmaTransfer.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t GetNextOamReadTimestamp() const;
+
     /// <summary>
     /// Handle a read request from the PPU memory. This routine will prioritize
     /// the cartridge read routine over the PPU space address.
@@ -188,7 +265,8 @@ class Ppu {
     void PpuWrite(uint16_t address, uint8_t data);
 
     /// <summary>
-    /// Retrieve a color from the palette. For more info refer to:
+    /// Retrieve a color from the palette, with the grayscale and color
+    /// emphasis of the mask register applied. For more info refer to:
     /// https://wiki.nesdev.com/w/index.php/PPU_palettes
     /// </summary>
     /// <param name="palette">Index of the palette to choose a color from</param>
@@ -197,12 +275,66 @@ class Ppu {
     int GetColorFromPalette(uint8_t palette, uint8_t pixel);
 
     /// <summary>
-    /// Return the raw data of the output screen. Each element is a color
-    /// pixel in format ARGB.
+    /// Return the raw data of the output screen, the last completed frame.
+    /// Each element is a color pixel in format ARGB. The PPU only draws the
+    /// indexed screen: it is converted here, once per completed frame.
     /// </summary>
     /// <returns></returns>
     const int* GetOutputScreen() const;
 
+    /// <summary>
+    /// Return the last completed frame as drawn by the PPU. Each element holds
+    /// the index of the color in the NES palette in the bits 0-5, with the
+    /// grayscale mode applied, and the color emphasis bits of the mask
+    /// register in the bits 6-8. See ConvertToArgb.
+    ///
+    /// The PPU draws into a back buffer, swapped with this one when a frame
+    /// is completed, so the contents do not change while the next frame is
+    /// drawn. The pointer itself changes on every completed frame.
+    /// </summary>
+    /// <returns></returns>
+    inline const uint16_t* GetIndexedScreen() const { return m_FrontScreen; }
+
+    /// <summary>
+    /// Blank the output screen, as it is on power up, for the states that
+    /// have not drawn a frame yet. Counts as a completed frame, so that the
+    /// consumers of the screen show it.
+    /// </summary>
+    void ClearOutputScreen();
+
+    /// <summary>
+    /// Number of frames drawn since creation. The frames emulated with
+    /// rendering disabled are not counted, they do not replace the output
+    /// screen.
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetCompletedFrameCount() const {
+        return m_CompletedFrameCount;
+    }
+
+    /// <summary>
+    /// Convert pixels of the indexed screen to ARGB colors
+    /// </summary>
+    /// <param name="indexedPixels"></param>
+    /// <param name="count"></param>
+    /// <param name="argbPixels"></param>
+    static void ConvertToArgb(const uint16_t* indexedPixels, size_t count,
+                              int* argbPixels);
+
+    /// <summary>
+    /// Enable or disable writing the pixels to the output screen. While it is
+    /// disabled, the PPU still composes the pixels that can raise a sprite
+    /// zero hit, so the emulation is not affected, but the output screen
+    /// keeps its previous contents. Used for the frames that are emulated
+    /// but never displayed.
+    /// </summary>
+    /// <param name="enabled"></param>
+    inline void SetRenderingEnabled(bool enabled) {
+        m_IsRenderingEnabled = enabled;
+    }
+
+    inline bool IsRenderingEnabled() const { return m_IsRenderingEnabled; }
+
     /// <summary>
     /// Return true when the PPU has finished processing a frame. This will be
     /// refactored in the future.
@@ -225,17 +357,87 @@ class Ppu {
     bool NeedsToDoNMI();
 
     /// <summary>
-    /// PPU OAM memory pointer. This is a hack-ish way to write to the OAM. In the
-    /// DMA tranfer, the data will be writing in order. This means that the tranfer will
-    /// copy the data defined in ObjectAttributeEntry in order, 64 times. This will be
-    /// refactored for a more readable process.
+    /// Write a byte of the OAM, as $2004 and the OAM DMA do
     /// </summary>
-    uint8_t* m_OAMPtr = (uint8_t*)m_OAM;
+    /// <param name="address">Byte of the OAM, 4 per ObjectAttributeEntry</param>
+    /// <param name="data"></param>
+    void WriteOam(uint8_t address, uint8_t data);
+
+    /// <summary>
+    /// Write the 256 bytes of the OAM at once, as a whole OAM DMA does
+    /// </summary>
+    /// <param name="data"></param>
+    void WriteOamPage(const uint8_t* data);
 
    private:
-    std::size_t GetNextActions(std::array<PpuAction, 3>& nextActions);
+    /// <summary>
+    /// Address decoding for the pages without a direct memory pointer
+    /// </summary>
+    uint8_t PpuReadHandler(uint16_t address);
+
+    /// <summary>
+    /// Recompute the colors of every palette entry, after the mask register
+    /// changed the grayscale or emphasis mode
+    /// </summary>
+    void ResolvePalette();
+
+    /// <summary>
+    /// Recompute the color of one palette entry (0 to 31) after a write
+    /// </summary>
+    void ResolvePaletteEntry(uint8_t entry);
+
     std::pair<uint8_t, uint8_t> GetCurrentPixelToRender();
 
+    /// <summary>
+    /// Mix a background pixel with the sprites at the current cycle, and
+    /// raise the sprite zero hit. Returns the pixel and palette to draw.
+    /// </summary>
+    std::pair<uint8_t, uint8_t> ComposePixel(uint8_t bgPixel,
+                                             uint8_t bgPalette);
+
+    /// <summary>
+    /// Mix a background pixel with the sprite pixel in front of the other
+    /// sprites, see ComposePixel
+    /// </summary>
+    std::pair<uint8_t, uint8_t> MixPixels(uint8_t bgPixel, uint8_t bgPalette,
+                                          uint8_t fgPixel, uint8_t fgPalette,
+                                          bool isFgInFront);
+
+    /// <summary>
+    /// Bucket the OAM entries by the scanlines they cover, in OAM order and
+    /// at most 8 per scanline, see DoPpuActionRenderDoOAMTransfer
+    /// </summary>
+    /// <param name="spriteHeight">8 or 16 pixels</param>
+    void BuildSpriteLists(uint8_t spriteHeight);
+
+    /// <summary>
+    /// Draw the sprites of the scanline, as loaded for the cycle 1, into a
+    /// line of 256 pixels. Each pixel is the one of the first sprite that is
+    /// not transparent there, with its palette and flags, see
+    /// SPRITE_LINE_PIXEL_MASK.
+    /// </summary>
+    void BuildSpriteLine(uint8_t* spriteLine) const;
+
+    /// <summary>
+    /// Move the sprite counters and shifters as on the cycles 2 to 256
+    /// </summary>
+    void SkipSpriteShifters();
+
+    /// <summary>
+    /// Run the cycles 1 to 256 of a visible scanline at once. The background
+    /// tiles are fetched in the same order as cycle by cycle, but the pixels
+    /// are drawn in spans of 8 straight from the fetched bitplanes instead of
+    /// going through the shifters. Only valid if no register can change
+    /// during these cycles, see CatchUp.
+    /// </summary>
+    void RenderScanline();
+
+    /// <summary>
+    /// Timestamp of the next tick at the given position of the frame,
+    /// numbered from the first cycle of the pre-render scanline
+    /// </summary>
+    uint64_t GetNextFrameTickTimestamp(uint32_t frameTick) const;
+
     void DoPpuActionPrerenderClear();
     void DoPpuActionPrerenderTransferY();
 
@@ -249,7 +451,18 @@ class Ppu {
     void DoPpuActionRenderEndFrameRendering();
 
     void UpdateShifters();
+    void UpdateSpriteShifters();
     void LoadBackgroundShifters();
+    void FetchNextTileId();
+    void FetchNextTileAttribute();
+    void FetchNextTilePattern(uint8_t plane);
+
+    /// <summary>
+    /// Fetch the row of the next background tile as 2 bit pixels, from the
+    /// tile cache if its page is cached. The bitplanes are then left
+    /// unread in m_NextBackgroundTileInfo.
+    /// </summary>
+    uint16_t FetchNextTileRow();
     void IncrementScrollX();
     void TransferAddressX();
 
@@ -288,12 +501,25 @@ class Ppu {
 
     uint8_t m_FineX = 0x00;
 
+    // Indexed screen being drawn, and last completed one
+    uint16_t* m_BackScreen = nullptr;
+    uint16_t* m_FrontScreen = nullptr;
+    uint64_t m_CompletedFrameCount = 0;
+
+    // ARGB copy of the front screen, converted on demand by GetOutputScreen
     int* m_OutputScreen = nullptr;
+    mutable bool m_IsOutputScreenStale = true;
 
     Cartridge* m_Cartridge = nullptr;
 
+    std::array<const uint8_t*, NUM_PPU_PAGES> m_ReadPages;
+
+    // Decoded tiles of the pattern table pages of m_ReadPages
+    ChrTileCache m_ChrTileCache;
+
     int16_t m_ScanLine = 0;
     int16_t m_Cycle = 0;
+    uint64_t m_Timestamp = 0;
 
     PpuRegister<StatusRegisterFields> m_StatusReg;
     PpuRegister<MaskRegisterFields> m_MaskReg;
@@ -327,15 +553,29 @@ class Ppu {
         uint8_t attribute;
         uint8_t x;
     };
-    ObjectAttributeEntry m_OAM[64];
+    ObjectAttributeEntry m_OAM[64] = {};
+
+    /// <summary>
+    /// PPU OAM memory pointer, to access the OAM byte by byte in the order of
+    /// the fields of ObjectAttributeEntry. Only WriteOam writes through it,
+    /// so that the sprite lists are kept up to date.
+    /// </summary>
+    uint8_t* m_OAMPtr = (uint8_t*)m_OAM;
 
     uint8_t m_OAMAddress = 0x00;
 
     ObjectAttributeEntry m_SpriteScanLine[8];
     uint8_t m_SpriteCount = 0;
 
-    uint8_t m_SpriteShifterPatternLo[8];
-    uint8_t m_SpriteShifterPatternHi[8];
+    // OAM entries of each visible scanline, see BuildSpriteLists. Built again
+    // when the OAM or the sprite height changed.
+    uint8_t m_ScanlineSprites[240][8];
+    uint8_t m_ScanlineSpriteCounts[240];
+    uint8_t m_SpriteListsHeight = 8;
+    bool m_AreSpriteListsStale = true;
+
+    // Rows of the sprites of the scanline, see ChrTileCache::Tile
+    uint16_t m_SpriteShifterPatterns[8] = {};
 
     bool m_SpriteZeroHitPossible = false;
     bool m_SpriteZeroBeingRendered = false;
@@ -344,20 +584,12 @@ class Ppu {
 
     bool m_DoNMI = false;
 
-    // Colors are in format ARGB
-    // Table taken from https://wiki.nesdev.com/w/index.php/PPU_palettes
-    static constexpr unsigned int m_PalScreen[0x40] = {
-        0xFF545454, 0xFF001E74, 0xFF081090, 0xFF300088, 0xFF440064, 0xFF5C0030,
-        0xFF540400, 0xFF3C1800, 0xFF202A00, 0xFF083A00, 0xFF004000, 0xFF003C00,
-        0xFF00323C, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF989698, 0xFF084CC4,
-        0xFF3032EC, 0xFF5C1EE4, 0xFF8814B0, 0xFFA01464, 0xFF982220, 0xFF783C00,
-        0xFF545A00, 0xFF287200, 0xFF087C00, 0xFF007628, 0xFF006678, 0xFF000000,
-        0xFF000000, 0xFF000000, 0xFFECEEEC, 0xFF4C9AEC, 0xFF787CEC, 0xFFB062EC,
-        0xFFE454EC, 0xFFEC58B4, 0xFFEC6A64, 0xFFD48820, 0xFFA0AA00, 0xFF74C400,
-        0xFF4CD020, 0xFF38CC6C, 0xFF38B4CC, 0xFF3C3C3C, 0xFF000000, 0xFF000000,
-        0xFFECEEEC, 0xFFA8CCEC, 0xFFBCBCEC, 0xFFD4B2EC, 0xFFECAEEC, 0xFFECAED4,
-        0xFFECD4AE, 0xFFE4C490, 0xFFCCD278, 0xFFB4DE78, 0xFFA8E290, 0xFF98E2B4,
-        0xFFA0D6E4, 0xFFA0A2A0, 0xFF000000, 0xFF000000};
+    bool m_IsRenderingEnabled = true;
+
+    // Indexed color of every palette entry, see GetIndexedScreen. Kept in
+    // sync with the palette table and the mask register so that drawing a
+    // pixel is a single lookup.
+    std::array<uint16_t, 32> m_ResolvedPalette;
 };
 
 }  // namespace dearnes
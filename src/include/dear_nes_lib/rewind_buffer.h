@@ -0,0 +1,115 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace dearnes {
+
+// Forward declarations
+class Nes;
+
+/// <summary>
+/// History of savestates, one per frame, used to run the emulation
+/// backwards. Every keyframeInterval frames the whole state is stored (a
+/// keyframe); the frames in between only store the delta of their state with
+/// the state of the previous frame, see state_delta.h. Since most of the
+/// machine does not change from one frame to the next, the deltas are a
+/// small fraction of the state.
+///
+/// The records are kept in a ring buffer of fixed size. When it is full, the
+/// oldest keyframe and its deltas are dropped, so the memory used never
+/// exceeds the budget.
+/// </summary>
+class RewindBuffer {
+   public:
+    /// <summary>
+    /// Create an empty history.
+    /// </summary>
+    /// <param name="memoryBudget">Size in bytes of the ring buffer</param>
+    /// <param name="keyframeInterval">Number of frames between two full
+    /// states. Longer intervals save memory, but make the rewinds that cross a
+    /// keyframe more expensive.</param>
+    RewindBuffer(size_t memoryBudget, uint32_t keyframeInterval = 60);
+
+    /// <summary>
+    /// Record the current state of the emulator. Meant to be called once per
+    /// frame. Returns false if the state does not fit in the memory budget.
+    /// </summary>
+    /// <param name="nes"></param>
+    /// <returns></returns>
+    bool Push(const Nes& nes);
+
+    /// <summary>
+    /// Restore the last recorded state and remove it from the history, so
+    /// that each call goes one frame further back. The output screen is not
+    /// part of the state: run a frame, without recording it, to draw it.
+    /// Returns false if the history is empty.
+    /// </summary>
+    /// <param name="nes"></param>
+    /// <returns></returns>
+    bool Rewind(Nes& nes);
+
+    /// <summary>
+    /// Drop the whole history
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Number of frames that can be rewound
+    /// </summary>
+    /// <returns></returns>
+    inline size_t GetFrameCount() const { return m_Records.size(); }
+
+    /// <summary>
+    /// Bytes of the ring buffer used by the recorded frames
+    /// </summary>
+    /// <returns></returns>
+    inline size_t GetMemoryUsage() const { return m_UsedBytes; }
+
+    inline size_t GetMemoryBudget() const { return m_Storage.size(); }
+
+   private:
+    struct Record {
+        size_t m_Offset = 0;
+        size_t m_Size = 0;
+        bool m_IsKeyframe = false;
+    };
+
+    /// <summary>
+    /// Find room for a new record of the given size at the end of the ring,
+    /// dropping the oldest records that are in the way. Returns false if the
+    /// size is larger than the whole buffer.
+    /// </summary>
+    bool Allocate(size_t size, size_t& offset);
+
+    /// <summary>
+    /// Remove the oldest record, and the deltas that depended on it if it was
+    /// a keyframe
+    /// </summary>
+    void DropOldestRecord();
+
+    /// <summary>
+    /// Rebuild in m_LastState the state of the last record, from its keyframe
+    /// </summary>
+    void RebuildLastState();
+
+    std::vector<uint8_t> m_Storage;
+    std::deque<Record> m_Records;
+
+    // Offset of the first byte after the newest record
+    size_t m_Head = 0;
+    size_t m_UsedBytes = 0;
+
+    uint32_t m_KeyframeInterval = 60;
+    uint32_t m_FramesSinceKeyframe = 0;
+
+    // Full state of the newest record, and scratch space for a new state and
+    // its delta
+    std::vector<uint8_t> m_LastState;
+    std::vector<uint8_t> m_NewState;
+    std::vector<uint8_t> m_Delta;
+};
+
+}  // namespace dearnes
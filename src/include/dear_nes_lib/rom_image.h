@@ -0,0 +1,92 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dear_nes_lib/cartridge_header.h"
+#include "dear_nes_lib/mapped_file.h"
+
+namespace dearnes {
+
+/// <summary>
+/// Read-only contents of an iNES file: the header and the program and
+/// character ROM. It is created once by the CartridgeLoader and shared,
+/// through a std::shared_ptr, by every Cartridge of the same game, so running
+/// many instances of a game does not duplicate its ROM. The memory that a
+/// cartridge can write to is owned by the Cartridge instead.
+/// The ROM is either read into buffers owned by the image, or read in place
+/// from a memory mapping of the file.
+/// </summary>
+class RomImage {
+   public:
+    RomImage(CartridgeHeader&& header, std::vector<uint8_t>&& programMemory,
+             std::vector<uint8_t>&& characterMemory);
+
+    /// <summary>
+    /// Create an image that refers to the ROM in the mapped file, without
+    /// copying it. The offsets and sizes must be within the file.
+    /// </summary>
+    RomImage(CartridgeHeader&& header, std::unique_ptr<MappedFile> mappedFile,
+             size_t programMemoryOffset, size_t programMemorySize,
+             size_t characterMemoryOffset, size_t characterMemorySize);
+
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    inline const CartridgeHeader& GetHeader() const { return m_Header; }
+
+    inline const uint8_t* GetProgramMemory() const { return m_ProgramMemory; }
+
+    inline size_t GetProgramMemorySize() const { return m_ProgramMemorySize; }
+
+    /// <summary>
+    /// Returns the character ROM. Its size is zero for the games that use
+    /// character RAM instead.
+    /// </summary>
+    /// <returns></returns>
+    inline const uint8_t* GetCharacterMemory() const {
+        return m_CharacterMemory;
+    }
+
+    inline size_t GetCharacterMemorySize() const {
+        return m_CharacterMemorySize;
+    }
+
+    /// <summary>
+    /// Returns true if the ROM is read from a memory mapping of the file
+    /// </summary>
+    /// <returns></returns>
+    inline bool IsMapped() const { return m_MappedFile != nullptr; }
+
+    /// <summary>
+    /// FNV-1a hash of the program and character ROM. The savestates use it
+    /// to tell the game they belong to, instead of holding the ROM. It is
+    /// computed on the first call, by any of the cartridges sharing the
+    /// image, so loading a game does not read the whole file.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t GetHash() const;
+
+   private:
+    void ComputeHash() const;
+
+    const CartridgeHeader m_Header;
+
+    // Only one of them backs the ROM
+    const std::vector<uint8_t> m_ProgramMemoryBuffer;
+    const std::vector<uint8_t> m_CharacterMemoryBuffer;
+    const std::unique_ptr<MappedFile> m_MappedFile;
+
+    const uint8_t* m_ProgramMemory = nullptr;
+    size_t m_ProgramMemorySize = 0;
+    const uint8_t* m_CharacterMemory = nullptr;
+    size_t m_CharacterMemorySize = 0;
+
+    mutable std::once_flag m_HashOnce;
+    mutable uint64_t m_Hash = 0;
+};
+
+}  // namespace dearnes
@@ -0,0 +1,116 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dearnes {
+
+/// <summary>
+/// Layout of a savestate blob, see Nes::SaveState:
+///
+///   Header      magic "DNES", format version, total size
+///   Cartridge   ROM hash, the memory the cartridge can write to, mapper state
+///   Nes         master clock counter
+///   Cpu         registers and instruction progress
+///   Bus         CPU RAM and controller registers
+///   Dma         transfer progress
+///   Ppu         VRAM, palette, OAM, registers, shifters and sprite state
+///
+/// Every field is copied as is, in the byte order of the host. The
+/// version must be increased whenever the layout changes.
+/// </summary>
+static constexpr uint32_t STATE_MAGIC = 0x53454E44;  // "DNES"
+static constexpr uint16_t STATE_VERSION = 3;
+
+struct StateHeader {
+    uint32_t m_Magic = STATE_MAGIC;
+    uint16_t m_Version = STATE_VERSION;
+    uint16_t m_Reserved = 0;
+    uint32_t m_Size = 0;
+};
+
+/// <summary>
+/// Start of the cartridge state. The ROM is not saved, only its hash, see
+/// RomImage::GetHash. The sizes are the ones of the character RAM and of the
+/// copies of the ROM that the cartridge made when the game wrote to it, and
+/// are zero for the memory still read from the ROM. Those bytes follow, then
+/// the mapper state. Without a cartridge every field is zero.
+/// </summary>
+struct CartridgeStateHeader {
+    uint64_t m_RomHash = 0;
+    uint32_t m_ProgramMemorySize = 0;
+    uint32_t m_CharacterMemorySize = 0;
+};
+
+/// <summary>
+/// Appends the fields of the emulator to a savestate buffer. The caller
+/// makes sure that the buffer is large enough. Without a buffer, it only
+/// counts the bytes, which is how the size of a savestate is found.
+/// </summary>
+class StateWriter {
+   public:
+    explicit StateWriter(uint8_t* buffer) : m_Buffer{buffer} {}
+
+    template <typename T>
+    inline void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only plain data can be written to a savestate");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    inline void WriteBytes(const void* data, size_t size) {
+        if (m_Buffer != nullptr) {
+            std::memcpy(m_Buffer + m_Offset, data, size);
+        }
+        m_Offset += size;
+    }
+
+    inline size_t GetOffset() const { return m_Offset; }
+
+   private:
+    uint8_t* m_Buffer = nullptr;
+    size_t m_Offset = 0;
+};
+
+/// <summary>
+/// Reads back, in the same order, the fields written by a StateWriter. The
+/// caller validates the size of the buffer beforehand.
+/// </summary>
+class StateReader {
+   public:
+    explicit StateReader(const uint8_t* buffer) : m_Buffer{buffer} {}
+
+    template <typename T>
+    inline void Read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only plain data can be read from a savestate");
+        ReadBytes(&value, sizeof(T));
+    }
+
+    inline void ReadBytes(void* data, size_t size) {
+        std::memcpy(data, m_Buffer + m_Offset, size);
+        m_Offset += size;
+    }
+
+    /// <summary>
+    /// Skip a block of bytes and return a pointer to it in the buffer, to
+    /// use it without copying it first
+    /// </summary>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    inline const uint8_t* ReadInPlace(size_t size) {
+        const uint8_t* data = m_Buffer + m_Offset;
+        m_Offset += size;
+        return data;
+    }
+
+    inline size_t GetOffset() const { return m_Offset; }
+
+   private:
+    const uint8_t* m_Buffer = nullptr;
+    size_t m_Offset = 0;
+};
+
+}  // namespace dearnes
@@ -0,0 +1,89 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace dearnes {
+
+/// <summary>
+/// Ticks of the master clock where a component acts by itself on the others,
+/// and that the components running ahead must stop at, see Scheduler
+/// </summary>
+enum class ScheduledEvent : uint8_t {
+    VERTICAL_BLANK,  // The PPU starts the vertical blank, raising a NMI
+    FRAME_END,       // The PPU completes the frame
+    DMA_TRANSFER,    // The OAM DMA runs its next tick
+};
+
+static constexpr size_t NUM_SCHEDULED_EVENTS = 3;
+
+/// <summary>
+/// Timeline of the upcoming events of the emulator, on the master clock.
+/// Each kind of event is scheduled at most once: scheduling it again moves
+/// it. The events are kept in a min-heap ordered by timestamp, so the next
+/// one is found without polling the components on every tick.
+/// </summary>
+class Scheduler {
+   public:
+    /// <summary>
+    /// Timestamp of the next event when none is scheduled
+    /// </summary>
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    Scheduler();
+
+    /// <summary>
+    /// Schedule an event, or move it if it is already scheduled
+    /// </summary>
+    /// <param name="event"></param>
+    /// <param name="timestamp">Master clock tick of the event</param>
+    void Schedule(ScheduledEvent event, uint64_t timestamp);
+
+    /// <summary>
+    /// Remove an event. Does nothing if it is not scheduled.
+    /// </summary>
+    /// <param name="event"></param>
+    void Cancel(ScheduledEvent event);
+
+    /// <summary>
+    /// Remove every event
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Remove the next event and return it. There must be one.
+    /// </summary>
+    /// <returns></returns>
+    ScheduledEvent PopNextEvent();
+
+    /// <summary>
+    /// Timestamp of the next event, or NEVER
+    /// </summary>
+    /// <returns></returns>
+    inline uint64_t GetNextTimestamp() const {
+        return m_Size > 0 ? m_Heap[0].m_Timestamp : NEVER;
+    }
+
+   private:
+    struct Entry {
+        uint64_t m_Timestamp;
+        ScheduledEvent m_Event;
+    };
+
+    static constexpr uint8_t NOT_SCHEDULED = 0xFF;
+
+    void SiftUp(size_t position);
+    void SiftDown(size_t position);
+    void Remove(size_t position);
+    void Place(size_t position, const Entry& entry);
+
+    std::array<Entry, NUM_SCHEDULED_EVENTS> m_Heap{};
+    size_t m_Size = 0;
+
+    // Position of each event in the heap, or NOT_SCHEDULED
+    std::array<uint8_t, NUM_SCHEDULED_EVENTS> m_Positions;
+};
+
+}  // namespace dearnes
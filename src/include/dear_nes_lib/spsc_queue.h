@@ -0,0 +1,65 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace dearnes {
+
+/// <summary>
+/// Lock-free ring of fixed capacity between one producer thread and one
+/// consumer thread. Each side only writes its own position, and reads the
+/// position of the other side to know how far it can go, so pushing and
+/// popping never block.
+/// </summary>
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "The capacity must be a power of two");
+
+   public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// <summary>
+    /// Append a value. Returns false, dropping the value, if the queue is
+    /// full. Producer thread only.
+    /// </summary>
+    /// <param name="value"></param>
+    /// <returns></returns>
+    bool Push(const T& value) {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_Items[tail & (Capacity - 1)] = value;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// Take the oldest value. Returns false if the queue is empty. Consumer
+    /// thread only.
+    /// </summary>
+    /// <param name="value"></param>
+    /// <returns></returns>
+    bool Pop(T& value) {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_Tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_Items[head & (Capacity - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    T m_Items[Capacity];
+
+    // Both positions only grow, the slot is the position modulo the capacity
+    alignas(64) std::atomic<size_t> m_Head{0};
+    alignas(64) std::atomic<size_t> m_Tail{0};
+};
+
+}  // namespace dearnes
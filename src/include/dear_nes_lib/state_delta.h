@@ -0,0 +1,37 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace dearnes {
+
+/// <summary>
+/// Encode the XOR of two states of the same size into a list of
+/// (unchanged bytes, changed bytes, XOR of the changed bytes) runs, with the
+/// run lengths as varints. Returns the size of the encoded delta, which is at
+/// most GetMaxStateDeltaSize(size).
+/// </summary>
+size_t EncodeStateDelta(const uint8_t* state, const uint8_t* previous,
+                        size_t size, uint8_t* delta);
+
+/// <summary>
+/// XOR a delta into a state. Applying the delta to one of the two states it
+/// was encoded from gives the other one.
+/// </summary>
+void ApplyStateDelta(const uint8_t* delta, size_t deltaSize, uint8_t* state);
+
+/// <summary>
+/// Check that a delta read from an untrusted source is well formed and only
+/// touches the first stateSize bytes, before applying it
+/// </summary>
+bool IsValidStateDelta(const uint8_t* delta, size_t deltaSize,
+                       size_t stateSize);
+
+/// <summary>
+/// Worst case of EncodeStateDelta: two 1 byte run lengths every 9 bytes
+/// </summary>
+inline size_t GetMaxStateDeltaSize(size_t stateSize) {
+    return stateSize + stateSize / 4 + 16;
+}
+
+}  // namespace dearnes
@@ -0,0 +1,82 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dearnes {
+
+// Bytes of a tile in the pattern tables: its 8 rows of bit 0 of the pixels,
+// then its 8 rows of bit 1
+static constexpr size_t SIZE_TILE = 16;
+
+/// <summary>
+/// Implementations of DecodeTiles. The SIMD ones decode all the rows of a
+/// tile at once, and are only available on the CPUs that support them.
+/// </summary>
+enum class TileDecoderKernel {
+    LUT,   // Table of the 256 bytes spread over 16 bits, one row at a time
+    SSE2,  // 8 rows at a time
+    AVX2,  // 16 rows at a time
+};
+
+constexpr std::array<uint16_t, 256> MakeSpreadBitsTable() {
+    std::array<uint16_t, 256> table{};
+    for (size_t value = 0; value < 256; ++value) {
+        for (size_t bit = 0; bit < 8; ++bit) {
+            if (value & (1 << bit)) {
+                table[value] |= 1 << (bit * 2);
+            }
+        }
+    }
+    return table;
+}
+
+/// <summary>
+/// Each byte with its bits moved to the even bits of a 16 bit word, see
+/// DecodeTileRow
+/// </summary>
+inline constexpr std::array<uint16_t, 256> SPREAD_BITS_TABLE =
+    MakeSpreadBitsTable();
+
+/// <summary>
+/// Combine the two bitplanes of a tile row into 8 pixels of 2 bits. The
+/// pixels go from left to right starting at the highest bits, like the bits
+/// of the bitplanes.
+/// </summary>
+/// <param name="lo">Bit 0 of the pixels</param>
+/// <param name="hi">Bit 1 of the pixels</param>
+/// <returns></returns>
+inline uint16_t DecodeTileRow(uint8_t lo, uint8_t hi) {
+    return static_cast<uint16_t>(SPREAD_BITS_TABLE[lo] |
+                                 (SPREAD_BITS_TABLE[hi] << 1));
+}
+
+/// <summary>
+/// Decode whole tiles, as laid out in the pattern tables, with the fastest
+/// kernel the CPU supports
+/// </summary>
+/// <param name="tiles">tileCount * SIZE_TILE bytes</param>
+/// <param name="tileCount"></param>
+/// <param name="rows">tileCount * 8 rows, see DecodeTileRow</param>
+void DecodeTiles(const uint8_t* tiles, size_t tileCount, uint16_t* rows);
+
+/// <summary>
+/// Same as DecodeTiles, with the given kernel. The kernel must be supported.
+/// </summary>
+void DecodeTiles(TileDecoderKernel kernel, const uint8_t* tiles,
+                 size_t tileCount, uint16_t* rows);
+
+/// <summary>
+/// Whether the kernel was compiled in and the CPU running it supports it
+/// </summary>
+bool IsTileDecoderKernelSupported(TileDecoderKernel kernel);
+
+/// <summary>
+/// Kernel used by DecodeTiles, chosen on the first call
+/// </summary>
+TileDecoderKernel GetBestTileDecoderKernel();
+
+const char* GetTileDecoderKernelName(TileDecoderKernel kernel);
+
+}  // namespace dearnes
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace dearnes {
+
+/// <summary>
+/// Lock-free hand-off of values, typically frames, from one producer thread
+/// to one consumer thread. Of the three buffers, the producer owns the back
+/// one, the consumer owns the front one, and the third one holds the last
+/// published value. Publishing and acquiring only swap a buffer with the
+/// middle one, so neither side ever waits for the other: the producer can
+/// publish faster than the consumer reads, the consumer then skips to the
+/// newest value.
+/// </summary>
+template <typename T>
+class TripleBuffer {
+   public:
+    TripleBuffer() = default;
+
+    /// <summary>
+    /// Create the three buffers as copies of the given value, for instance
+    /// to size them
+    /// </summary>
+    /// <param name="value"></param>
+    explicit TripleBuffer(const T& value) : m_Buffers{value, value, value} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /// <summary>
+    /// Buffer to fill with the next value. Producer thread only.
+    /// </summary>
+    /// <returns></returns>
+    inline T& GetBackBuffer() { return m_Buffers[m_BackIdx]; }
+
+    /// <summary>
+    /// Make the back buffer the newest value, and take the previous middle
+    /// buffer as the next back buffer. Producer thread only.
+    /// </summary>
+    inline void Publish() {
+        m_BackIdx = m_MiddleIdx.exchange(m_BackIdx | IS_NEW_BIT,
+                                         std::memory_order_acq_rel) &
+                    INDEX_MASK;
+    }
+
+    /// <summary>
+    /// Make the newest published value the front buffer. Returns false,
+    /// keeping the current front buffer, if nothing was published since the
+    /// last call. Consumer thread only.
+    /// </summary>
+    /// <returns></returns>
+    inline bool Acquire() {
+        if ((m_MiddleIdx.load(std::memory_order_relaxed) & IS_NEW_BIT) == 0) {
+            return false;
+        }
+        m_FrontIdx =
+            m_MiddleIdx.exchange(m_FrontIdx, std::memory_order_acq_rel) &
+            INDEX_MASK;
+        return true;
+    }
+
+    /// <summary>
+    /// Value taken by the last successful Acquire. Consumer thread only.
+    /// </summary>
+    /// <returns></returns>
+    inline const T& GetFrontBuffer() const { return m_Buffers[m_FrontIdx]; }
+
+   private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    // Set in the middle index when it holds a value the consumer has not
+    // acquired yet
+    static constexpr uint8_t IS_NEW_BIT = 0x04;
+
+    T m_Buffers[3];
+
+    // Each index is only touched by its own side, except the middle one. They
+    // are kept on separate cache lines so that the two threads do not keep
+    // stealing the line from each other.
+    alignas(64) uint8_t m_BackIdx = 0;
+    alignas(64) std::atomic<uint8_t> m_MiddleIdx{1};
+    alignas(64) uint8_t m_FrontIdx = 2;
+};
+
+}  // namespace dearnes
@@ -0,0 +1,89 @@
+// Copyright (c) 2026 Emmanuel Arias
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dearnes {
+
+/// <summary>
+/// Fixed size pool of worker threads. Each worker owns a queue of tasks: it
+/// takes the newest task from its own queue, and when that one is empty it
+/// steals the oldest task from the queue of another worker. Tasks submitted
+/// from a worker thread go to the queue of that worker, so a task that
+/// resubmits itself tends to stay on the same thread (and cache) unless other
+/// workers run out of work.
+/// </summary>
+class WorkStealingPool {
+   public:
+    using Task = std::function<void()>;
+
+    /// <summary>
+    /// Start the worker threads
+    /// </summary>
+    /// <param name="numThreads">Number of workers, at least one</param>
+    explicit WorkStealingPool(size_t numThreads);
+
+    /// <summary>
+    /// Wait for the pending tasks and stop the worker threads
+    /// </summary>
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// <summary>
+    /// Queue a task. It can be called from any thread, including from a task
+    /// running in the pool.
+    /// </summary>
+    /// <param name="task"></param>
+    void Submit(Task task);
+
+    /// <summary>
+    /// Block until every submitted task has finished, including the tasks
+    /// submitted by other tasks in the meantime. Must not be called from a
+    /// task running in the pool.
+    /// </summary>
+    void Wait();
+
+    /// <summary>
+    /// Returns the number of worker threads
+    /// </summary>
+    /// <returns></returns>
+    inline size_t GetThreadCount() const { return m_Threads.size(); }
+
+   private:
+    struct WorkerQueue {
+        std::mutex m_Mutex;
+        std::deque<Task> m_Tasks;
+    };
+
+    void WorkerLoop(size_t workerIdx);
+
+    bool PopLocalTask(size_t workerIdx, Task& task);
+
+    bool StealTask(size_t workerIdx, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_StateMutex;
+    std::condition_variable m_TaskAvailable;
+    std::condition_variable m_AllTasksDone;
+
+    // Tasks sitting in a queue, used to put idle workers to sleep
+    std::atomic<size_t> m_QueuedTasks{0};
+    // Tasks submitted and not finished yet, used by Wait()
+    std::atomic<size_t> m_PendingTasks{0};
+    std::atomic<size_t> m_NextQueue{0};
+
+    bool m_Stop = false;
+};
+
+}  // namespace dearnes
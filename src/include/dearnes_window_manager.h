@@ -1,9 +1,11 @@
 // Copyright (c) 2020-2021 Emmanuel Arias
 #pragma once
+#include <cstdint>
 #include <string>
 #include "include/imgui_window_manager.h"
 
 namespace dearnes {
+class EmulationThread;
 class Nes;
 }
 
@@ -11,14 +13,23 @@ class StatusWidget;
 
 struct DearNESWindowManager : public ImGuiWindowManager {
 
-    DearNESWindowManager(dearnes::Nes* nesPtr);
+    DearNESWindowManager(dearnes::Nes* nesPtr,
+                         dearnes::EmulationThread* emulationThreadPtr);
 
     virtual void RegisterWidgets() override;
 
     StatusWidget* m_NesStatusWindow = nullptr;
 
     private:
+    /// <summary>
+    /// Send the keyboard state to the emulation thread: the controller of
+    /// player 1, and rewinding while backspace is held down
+    /// </summary>
     virtual void ProcessInput(GLFWwindow* window) override;
 
     dearnes::Nes* m_NesPtr = nullptr;
+    dearnes::EmulationThread* m_EmulationThreadPtr = nullptr;
+
+    // Last controller state sent, the input is only sent when it changes
+    uint8_t m_LastButtons = 0;
 };
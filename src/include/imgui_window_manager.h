@@ -1,5 +1,6 @@
 // Copyright (c) 2020-2021 Emmanuel Arias
 #pragma once
+#include <mutex>
 #include <vector>
 
 struct GLFWwindow;
@@ -20,6 +21,13 @@ class ImGuiWindowManager {
     void Update(float deltaTime);
     void Render();
 
+    /// <summary>
+    /// Mutex held while the widgets update and render, for widgets that read
+    /// data owned by another thread. Presenting the frame is done without it.
+    /// </summary>
+    /// <param name="mutex"></param>
+    inline void SetWidgetMutex(std::mutex* mutex) { m_WidgetMutex = mutex; }
+
     void DestroyWindow();
 
    protected:
@@ -28,6 +36,7 @@ class ImGuiWindowManager {
    private:
     GLFWwindow* m_Window = nullptr;
     std::vector<BaseWidget*> m_Widgets;
+    std::mutex* m_WidgetMutex = nullptr;
 
     void ShowDockSpace(bool* p_open);
 };
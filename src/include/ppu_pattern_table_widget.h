@@ -1,6 +1,7 @@
 // Copyright (c) 2020-2021 Emmanuel Arias
 #pragma once
 #include <string>
+#include <vector>
 
 #include "include/dearnes_base_widget.h"
 #include "include/texture_image.h"
@@ -18,9 +19,13 @@ class PpuPatternTableWidget : public DearNESBaseWidget {
     static constexpr unsigned int DEFAULT_PALETTE = 0;
     static constexpr unsigned int PATTERN_TABLE_REAL_WIDTH = 128;
     static constexpr unsigned int PATTERN_TABLE_REAL_HEIGHT = 128;
+    static constexpr size_t NUM_TILES = 256;
 
     unsigned int m_PatternTableIdx = 0;
     std::string m_WindowName;
     ImGuiTextureImage m_PpuPatternTable =
         ImGuiTextureImage{PATTERN_TABLE_REAL_WIDTH, PATTERN_TABLE_REAL_HEIGHT};
+    // ARGB pixels of the pattern table, uploaded to the texture
+    std::vector<int> m_Pixels =
+        std::vector<int>(PATTERN_TABLE_REAL_WIDTH * PATTERN_TABLE_REAL_HEIGHT);
 };
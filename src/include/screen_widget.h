@@ -6,9 +6,14 @@
 #include "include/base_widget.h"
 #include "include/texture_image.h"
 
+namespace dearnes {
+class EmulationThread;
+}
+
 class ScreenWidget : public DearNESBaseWidget {
    public:
-ScreenWidget(dearnes::Nes* nesPtr);
+ScreenWidget(dearnes::Nes* nesPtr,
+             dearnes::EmulationThread* emulationThreadPtr);
 
     virtual void Update(float delta) override;
     virtual void Render() override;
@@ -19,4 +24,6 @@ ScreenWidget(dearnes::Nes* nesPtr);
     const std::string m_WindowName = "NES Screen";
     ImGuiTextureImage m_NesScreenTextureImage = ImGuiTextureImage{
         SCREEN_REAL_WIDHT, SCREEN_REAL_HEIGHT};
+    // Source of the frames, which does not need the emulator
+    dearnes::EmulationThread* m_EmulationThreadPtr = nullptr;
 };
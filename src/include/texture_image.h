@@ -17,6 +17,10 @@ class ImGuiTextureImage {
 
     void CopyTextureFromArray(const int* intArray);
 
+    // Upload the pixels to the texture straight from the array, without
+    // keeping a copy. SetPixel and Update work on the previous contents.
+    void UpdateFromArray(const int* intArray);
+
     void ScaleImageToWidth(float newWidth);
 
     void ScaleImageToHeight(float newHeight);
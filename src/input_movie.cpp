@@ -0,0 +1,328 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/input_movie.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/state_delta.h"
+
+namespace dearnes {
+
+namespace {
+
+/// <summary>
+/// Layout of a movie file:
+///
+///   MovieHeader
+///   Input       NUM_CONTROLLERS bytes per frame
+///   Keyframes   one KeyframeEntry per keyframe
+///   States      the keyframes, whole or as a delta with the previous one
+///
+/// Like savestates, the fields are in the byte order of the host.
+/// </summary>
+constexpr uint32_t MOVIE_MAGIC = 0x4D4E4544;  // "DENM"
+// Must be increased with STATE_VERSION too, the movies embed savestates
+constexpr uint16_t MOVIE_VERSION = 2;
+
+struct MovieHeader {
+    uint32_t m_Magic = MOVIE_MAGIC;
+    uint16_t m_Version = MOVIE_VERSION;
+    uint8_t m_NumControllers = NUM_CONTROLLERS;
+    uint8_t m_Reserved = 0;
+    uint32_t m_KeyframeInterval = 0;
+    uint32_t m_StateSize = 0;
+    uint64_t m_FrameCount = 0;
+    uint64_t m_KeyframeCount = 0;
+};
+
+struct KeyframeEntry {
+    uint32_t m_Size = 0;
+    uint32_t m_IsDelta = 0;
+};
+
+}  // namespace
+
+InputMovie::InputMovie(uint32_t keyframeInterval)
+    : m_KeyframeInterval{keyframeInterval > 0 ? keyframeInterval : 1} {}
+
+void InputMovie::Clear() {
+    m_Input.clear();
+    m_Keyframes.clear();
+    m_KeyframeData.clear();
+    m_StateSize = 0;
+    m_IsDecodedStateValid = false;
+}
+
+bool InputMovie::RecordFrame(const Nes& nes) {
+    const uint64_t frame = GetFrameCount();
+    if (frame % m_KeyframeInterval == 0) {
+        // The state grows when the game writes to its ROM, see
+        // Nes::GetStateSize. A larger state is stored whole, so the movie
+        // always holds one of m_StateSize bytes.
+        const size_t stateSize = nes.GetStateSize();
+        const bool isLarger = stateSize > m_StateSize;
+        if (isLarger) {
+            ResizeStates(stateSize);
+        }
+        std::fill(m_NewState.begin() + stateSize, m_NewState.end(),
+                  uint8_t{0});
+        if (!nes.SaveState(m_NewState.data(), stateSize)) {
+            return false;
+        }
+
+        Keyframe keyframe{m_KeyframeData.size(), stateSize, false};
+        const uint8_t* data = m_NewState.data();
+        if (!isLarger) {
+            DecodeKeyframe(m_Keyframes.size() - 1);
+            const size_t deltaSize =
+                EncodeStateDelta(m_NewState.data(), m_DecodedState.data(),
+                                 m_StateSize, m_Delta.data());
+            if (deltaSize < stateSize) {
+                data = m_Delta.data();
+                keyframe.m_Size = deltaSize;
+                keyframe.m_IsDelta = true;
+            }
+        }
+        m_KeyframeData.insert(m_KeyframeData.end(), data,
+                              data + keyframe.m_Size);
+        m_Keyframes.push_back(keyframe);
+
+        std::swap(m_DecodedState, m_NewState);
+        m_DecodedKeyframeIdx = m_Keyframes.size() - 1;
+        m_IsDecodedStateValid = true;
+    }
+
+    for (size_t idx = 0; idx < NUM_CONTROLLERS; ++idx) {
+        m_Input.push_back(nes.GetControllerState(idx));
+    }
+    return true;
+}
+
+bool InputMovie::PlayFrame(Nes& nes, uint64_t frame) const {
+    if (frame >= GetFrameCount()) {
+        return false;
+    }
+    for (size_t idx = 0; idx < NUM_CONTROLLERS; ++idx) {
+        nes.ClearControllerState(idx);
+        nes.WriteControllerState(idx, GetInput(frame, idx));
+    }
+    return true;
+}
+
+bool InputMovie::Seek(Nes& nes, uint64_t frame) {
+    if (m_Keyframes.empty() || frame > GetFrameCount()) {
+        return false;
+    }
+    // Start from the keyframe before the one of the frame, if it has one,
+    // so that at least the frame before the target is replayed and drawn.
+    // The keyframes do not hold the screen. This also covers the end of a
+    // movie whose length is a multiple of the interval, which has no
+    // keyframe of its own.
+    const size_t keyframeIdx =
+        frame > 0 ? static_cast<size_t>((frame - 1) / m_KeyframeInterval) : 0;
+    DecodeKeyframe(keyframeIdx);
+    if (!nes.LoadState(m_DecodedState.data(), m_StateSize)) {
+        return false;
+    }
+    if (frame == 0) {
+        // Nothing to replay: the starting state has not drawn anything yet
+        nes.GetPpu()->ClearOutputScreen();
+        return true;
+    }
+
+    // Replay the frames up to the target as fast as possible: one frame at a
+    // time, and only the last one drawn
+    const uint32_t runAheadFrames = nes.GetRunAheadFrames();
+    nes.SetRunAheadFrames(0);
+    Ppu* ppu = nes.GetPpu();
+    const bool isRenderingEnabled = ppu->IsRenderingEnabled();
+    for (uint64_t i = uint64_t{keyframeIdx} * m_KeyframeInterval; i < frame;
+         ++i) {
+        ppu->SetRenderingEnabled(isRenderingEnabled && i + 1 == frame);
+        PlayFrame(nes, i);
+        nes.DoFrame();
+    }
+    ppu->SetRenderingEnabled(isRenderingEnabled);
+    nes.SetRunAheadFrames(runAheadFrames);
+    return true;
+}
+
+void InputMovie::Truncate(uint64_t frame) {
+    if (frame >= GetFrameCount()) {
+        return;
+    }
+    m_Input.resize(static_cast<size_t>(frame) * NUM_CONTROLLERS);
+
+    // Keep the keyframes of the frames before, the next RecordFrame adds the
+    // one of this frame if needed
+    const size_t keyframeCount = static_cast<size_t>(
+        (frame + m_KeyframeInterval - 1) / m_KeyframeInterval);
+    if (keyframeCount < m_Keyframes.size()) {
+        m_KeyframeData.resize(m_Keyframes[keyframeCount].m_Offset);
+        m_Keyframes.resize(keyframeCount);
+        if (m_DecodedKeyframeIdx >= keyframeCount) {
+            m_IsDecodedStateValid = false;
+        }
+    }
+
+    // The largest states may have been dropped
+    size_t stateSize = 0;
+    for (const Keyframe& keyframe : m_Keyframes) {
+        if (!keyframe.m_IsDelta) {
+            stateSize = std::max(stateSize, keyframe.m_Size);
+        }
+    }
+    ResizeStates(stateSize);
+}
+
+bool InputMovie::SaveToFile(const std::string& fileName) const {
+    std::ofstream ofs{fileName, std::ofstream::binary};
+    if (!ofs.is_open()) {
+        return false;
+    }
+
+    MovieHeader header;
+    header.m_KeyframeInterval = m_KeyframeInterval;
+    header.m_StateSize = static_cast<uint32_t>(m_StateSize);
+    header.m_FrameCount = GetFrameCount();
+    header.m_KeyframeCount = m_Keyframes.size();
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(m_Input.data()), m_Input.size());
+    for (const Keyframe& keyframe : m_Keyframes) {
+        const KeyframeEntry entry{static_cast<uint32_t>(keyframe.m_Size),
+                                  keyframe.m_IsDelta ? 1u : 0u};
+        ofs.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    ofs.write(reinterpret_cast<const char*>(m_KeyframeData.data()),
+              m_KeyframeData.size());
+    return ofs.good();
+}
+
+MovieLoaderError InputMovie::LoadFromFile(const std::string& fileName,
+                                           const Nes& nes) {
+    Clear();
+
+    std::ifstream ifs{fileName, std::ifstream::binary | std::ifstream::ate};
+    if (!ifs.is_open()) {
+        return MovieLoaderError::FILE_NOT_FOUND;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(ifs.tellg());
+    ifs.seekg(0);
+
+    // Check every size against the size of the file before allocating
+    MovieHeader header;
+    if (fileSize < sizeof(header) ||
+        !ifs.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_Magic != MOVIE_MAGIC) {
+        return MovieLoaderError::INVALID_MOVIE;
+    }
+    // The embedded states of older movies can not be loaded anymore
+    if (header.m_Version != MOVIE_VERSION) {
+        return MovieLoaderError::VERSION_NOT_SUPPORTED;
+    }
+    if (header.m_NumControllers != NUM_CONTROLLERS ||
+        header.m_KeyframeInterval == 0) {
+        return MovieLoaderError::INVALID_MOVIE;
+    }
+    const uint64_t expectedKeyframes =
+        (header.m_FrameCount + header.m_KeyframeInterval - 1) /
+        header.m_KeyframeInterval;
+    const uint64_t remainingSize = fileSize - sizeof(header);
+    // The embedded states are savestates of the running game, and the first
+    // one is stored whole in the file. A movie without frames has none.
+    const bool isStateSizeValid =
+        header.m_KeyframeCount == 0
+            ? header.m_StateSize == 0
+            : header.m_StateSize <= remainingSize &&
+                  header.m_StateSize <= nes.GetMaxStateSize();
+    if (!isStateSizeValid ||
+        header.m_FrameCount > remainingSize / NUM_CONTROLLERS ||
+        header.m_KeyframeCount != expectedKeyframes ||
+        header.m_KeyframeCount * sizeof(KeyframeEntry) >
+            remainingSize - header.m_FrameCount * NUM_CONTROLLERS) {
+        return MovieLoaderError::INVALID_MOVIE;
+    }
+
+    std::vector<uint8_t> input(
+        static_cast<size_t>(header.m_FrameCount * NUM_CONTROLLERS));
+    ifs.read(reinterpret_cast<char*>(input.data()), input.size());
+
+    std::vector<Keyframe> keyframes(
+        static_cast<size_t>(header.m_KeyframeCount));
+    size_t dataSize = 0;
+    for (Keyframe& keyframe : keyframes) {
+        KeyframeEntry entry;
+        ifs.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        keyframe.m_Offset = dataSize;
+        keyframe.m_Size = entry.m_Size;
+        keyframe.m_IsDelta = entry.m_IsDelta != 0;
+        dataSize += entry.m_Size;
+    }
+    if (!ifs || dataSize != fileSize - static_cast<uint64_t>(ifs.tellg())) {
+        return MovieLoaderError::INVALID_MOVIE;
+    }
+
+    std::vector<uint8_t> keyframeData(dataSize);
+    if (!ifs.read(reinterpret_cast<char*>(keyframeData.data()), dataSize)) {
+        return MovieLoaderError::INVALID_MOVIE;
+    }
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+        const Keyframe& keyframe = keyframes[i];
+        const uint8_t* data = keyframeData.data() + keyframe.m_Offset;
+        const bool isValid =
+            keyframe.m_IsDelta
+                ? i > 0 && IsValidStateDelta(data, keyframe.m_Size,
+                                             header.m_StateSize)
+                : keyframe.m_Size <= header.m_StateSize;
+        if (!isValid) {
+            return MovieLoaderError::INVALID_MOVIE;
+        }
+    }
+
+    m_KeyframeInterval = header.m_KeyframeInterval;
+    m_Input = std::move(input);
+    m_Keyframes = std::move(keyframes);
+    m_KeyframeData = std::move(keyframeData);
+    ResizeStates(header.m_StateSize);
+    return MovieLoaderError::OK;
+}
+
+void InputMovie::DecodeKeyframe(size_t keyframeIdx) {
+    if (m_IsDecodedStateValid && m_DecodedKeyframeIdx == keyframeIdx) {
+        return;
+    }
+
+    // Go back to the last whole keyframe, or to the decoded one
+    size_t startIdx = keyframeIdx;
+    auto IsDecoded = [&](size_t idx) {
+        return m_IsDecodedStateValid && m_DecodedKeyframeIdx == idx;
+    };
+    while (!IsDecoded(startIdx) && m_Keyframes[startIdx].m_IsDelta) {
+        --startIdx;
+    }
+    if (!IsDecoded(startIdx)) {
+        const Keyframe& keyframe = m_Keyframes[startIdx];
+        std::copy_n(&m_KeyframeData[keyframe.m_Offset], keyframe.m_Size,
+                    m_DecodedState.data());
+        std::fill(m_DecodedState.begin() + keyframe.m_Size,
+                  m_DecodedState.end(), uint8_t{0});
+    }
+    for (size_t i = startIdx + 1; i <= keyframeIdx; ++i) {
+        ApplyStateDelta(&m_KeyframeData[m_Keyframes[i].m_Offset],
+                        m_Keyframes[i].m_Size, m_DecodedState.data());
+    }
+    m_DecodedKeyframeIdx = keyframeIdx;
+    m_IsDecodedStateValid = true;
+}
+
+void InputMovie::ResizeStates(size_t stateSize) {
+    // Growing pads the states with zeros
+    m_StateSize = stateSize;
+    m_DecodedState.resize(stateSize);
+    m_NewState.resize(stateSize);
+    m_Delta.resize(GetMaxStateDeltaSize(stateSize));
+}
+
+}  // namespace dearnes
\ No newline at end of file
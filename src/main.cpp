@@ -2,6 +2,8 @@
 #include <chrono>
 
 #include "dear_nes_lib/cartridge_loader.h"
+#include "dear_nes_lib/emulation_thread.h"
+#include "dear_nes_lib/frame_pacer.h"
 #include "dear_nes_lib/nes.h"
 #include "helpers/RootDir.h"
 #include "include/dearnes_window_manager.h"
@@ -13,7 +15,12 @@ using Cartridge = dearnes::Cartridge;
 int main(int argc, char* argv[]) {
     Nes* nesEmulator = new Nes();
 
-    DearNESWindowManager dearNESWindowManager{nesEmulator};
+    // Several minutes of history for the usual game
+    constexpr size_t rewindMemoryBudget = 64 << 20;
+    dearnes::EmulationThread emulationThread{nesEmulator,
+                                             rewindMemoryBudget};
+
+    DearNESWindowManager dearNESWindowManager{nesEmulator, &emulationThread};
     bool success = dearNESWindowManager.CreateWindow();
     if (!success) {
         return 1;
@@ -32,36 +39,33 @@ int main(int argc, char* argv[]) {
 
     auto nesStatusWindow = dearNESWindowManager.m_NesStatusWindow;
 
-    constexpr float frameTime = 1.f / 60;
-    typedef std::chrono::high_resolution_clock clock;
-    typedef std::chrono::duration<float> duration;
-    
-    float residualTime = 0.f;
+    // The emulation runs at its own pace on the emulation thread. This loop
+    // only sends the input and draws the newest frame; the debug widgets
+    // read the emulator between two of its frames.
+    dearNESWindowManager.SetWidgetMutex(&emulationThread.GetNesMutex());
+    emulationThread.SetRunning(nesStatusWindow->IsNesPoweredUp());
+    emulationThread.Start();
+
+    // Drawing faster than the emulation would only show the same frame again,
+    // so the loop sleeps between frames instead of polling
+    dearnes::FramePacer uiPacer;
     auto previousTime = std::chrono::steady_clock::now();
     while (!dearNESWindowManager.ShouldClose()) {
         auto currentTime = std::chrono::steady_clock::now();
-        float deltaTime = std::chrono::duration<float>(
-                              std::chrono::steady_clock::now() - previousTime)
-                              .count();
+        float deltaTime =
+            std::chrono::duration<float>(currentTime - previousTime).count();
         previousTime = currentTime;
 
         dearNESWindowManager.HandleEvents();
-
-        if (nesStatusWindow->IsNesPoweredUp() &&
-            nesEmulator->IsCartridgeLoaded()) {
-            if (residualTime > 0) {
-                residualTime -= deltaTime;
-            } else {
-                residualTime += frameTime - deltaTime;
-
-                nesEmulator->DoFrame();
-            }
-        }
+        emulationThread.SetRunning(nesStatusWindow->IsNesPoweredUp());
 
         dearNESWindowManager.Update(deltaTime);
         dearNESWindowManager.Render();
+
+        uiPacer.WaitForNextFrame();
     }
 
+    emulationThread.Stop();
     dearNESWindowManager.DestroyWindow();
 
     delete nesEmulator;
@@ -0,0 +1,91 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dearnes {
+
+MappedFile::MappedFile(const uint8_t* data, size_t size)
+    : m_Data{data}, m_Size{size} {}
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) ||
+        size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // The view keeps the mapping alive, so both handles can be closed
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<MappedFile>(
+        new MappedFile{static_cast<const uint8_t*>(data),
+                       static_cast<size_t>(size.QuadPart)});
+}
+
+MappedFile::~MappedFile() { UnmapViewOfFile(m_Data); }
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& fileName) {
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) ||
+        status.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping stays valid after closing the file descriptor
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<MappedFile>(
+        new MappedFile{static_cast<const uint8_t*>(data), size});
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<uint8_t*>(m_Data), m_Size);
+}
+
+#endif
+
+}  // namespace dearnes
@@ -2,6 +2,31 @@
 #include "dear_nes_lib/mapper.h"
 
 namespace dearnes {
-IMapper::IMapper(uint8_t prgBanks, uint8_t chrBanks)
+MapperBase::MapperBase(uint8_t prgBanks, uint8_t chrBanks)
     : m_PrgBanks{prgBanks}, m_ChrBanks{chrBanks} {}
+
+bool MapperBase::CpuMapReadPage(uint8_t /*page*/,
+                                uint32_t & /*mappedAddr*/) {
+    return false;
+}
+
+bool MapperBase::CpuMapWritePage(uint8_t /*page*/,
+                                 uint32_t & /*mappedAddr*/) {
+    return false;
+}
+
+bool MapperBase::PpuMapReadPage(uint8_t /*page*/,
+                                uint32_t & /*mappedAddr*/) {
+    return false;
+}
+
+void MapperBase::SaveState(StateWriter & /*writer*/) const {}
+
+void MapperBase::LoadState(StateReader & /*reader*/) {}
+
+bool MapperBase::ConsumeMappingChanged() {
+    const bool changed = m_MappingChanged;
+    m_MappingChanged = false;
+    return changed;
+}
 }  // namespace dearnes
\ No newline at end of file
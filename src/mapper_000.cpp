@@ -1,9 +1,11 @@
 // Copyright (c) 2020 Emmanuel Arias
 #include "dear_nes_lib/mapper_000.h"
 
+#include "dear_nes_lib/enums.h"
+
 namespace dearnes {
 Mapper_000::Mapper_000(uint8_t prgBanks, uint8_t chrBanks)
-    : IMapper{prgBanks, chrBanks} {}
+    : MapperBase{prgBanks, chrBanks} {}
 
 bool Mapper_000::CpuMapRead(uint16_t addr, uint32_t& mappedAddr) {
     if (addr >= 0x8000 && addr <= 0xFFFF) {
@@ -21,6 +23,12 @@ bool Mapper_000::CpuMapWrite(uint16_t addr, uint32_t& mappedAddr) {
     return false;
 }
 
+bool Mapper_000::CpuMapReadPage(uint8_t page, uint32_t& mappedAddr) {
+    // Same mapping as CpuMapRead. Writes are left to CpuMapWrite.
+    return CpuMapRead(static_cast<uint16_t>(page << CPU_PAGE_SHIFT),
+                      mappedAddr);
+}
+
 bool Mapper_000::PpuMapRead(uint16_t addr, uint32_t& mappedAddr) {
     if (addr >= 0x0000 && addr <= 0x1FFF) {
         mappedAddr = addr;
@@ -29,8 +37,18 @@ bool Mapper_000::PpuMapRead(uint16_t addr, uint32_t& mappedAddr) {
     return false;
 }
 
+bool Mapper_000::PpuMapReadPage(uint8_t page, uint32_t& mappedAddr) {
+    return PpuMapRead(static_cast<uint16_t>(page << PPU_PAGE_SHIFT),
+                      mappedAddr);
+}
+
 bool Mapper_000::PpuMapWrite(uint16_t addr, uint32_t& mappedAddr) {
-    // no writing in ROM
+    // no writing in ROM, but the cartridges without character ROM have 8 KB
+    // of character RAM instead
+    if (m_ChrBanks == 0 && addr >= 0x0000 && addr <= 0x1FFF) {
+        mappedAddr = addr;
+        return true;
+    }
     return false;
 }
 
@@ -6,12 +6,15 @@
 
 #include "dear_nes_lib/cartridge.h"
 #include "dear_nes_lib/enums.h"
+#include "dear_nes_lib/save_state.h"
 
 namespace dearnes {
 
 Nes::Nes() {
     m_Bus.SetPpu(&m_Ppu);
     m_Bus.SetDma(&m_Dma);
+    m_Bus.SetSystemClock(&m_SystemClockCounter);
+    m_Bus.SetScheduler(&m_Scheduler);
 
     m_Dma.SetBus(&m_Bus);
 
@@ -42,7 +45,10 @@ void Nes::Reset() {
         return;
     }
     m_Cpu.Reset();
+    ++m_ResetCount;
     m_SystemClockCounter = 0;
+    m_NextCpuTick = 0;
+    m_Ppu.SetTimestamp(0);
 }
 
 void Nes::Clock() {
@@ -56,12 +62,13 @@ void Nes::Clock() {
                 m_Dma.ReadData();
             } else {
                 auto [addr, data] = m_Dma.GetLastReadData();
-                m_Ppu.m_OAMPtr[addr] = data;
+                m_Ppu.WriteOam(addr, data);
             }
         }
     };
     m_Ppu.Clock();
-    if (m_SystemClockCounter % 3 == 0) {
+    if (m_SystemClockCounter == m_NextCpuTick) {
+        m_NextCpuTick += 3;
         if (m_Dma.IsTranferInProgress()) {
             DoDMATransfer();
         } else {
@@ -74,13 +81,165 @@ void Nes::Clock() {
     ++m_SystemClockCounter;
 }
 
+void Nes::SkipIdleTicks(uint64_t eventTick) {
+    // Once the remaining cycles of the CPU run out, its next tick fetches a
+    // new instruction
+    const uint64_t ticksToCpuTick = m_NextCpuTick - m_SystemClockCounter;
+    const uint32_t remainingCycles = m_Cpu.GetRemainingCycles();
+    const uint64_t ticksToInstruction = ticksToCpuTick + 3 * remainingCycles;
+
+    const uint64_t ticksToEvent = eventTick - m_SystemClockCounter;
+    if (ticksToInstruction <= ticksToEvent) {
+        m_Cpu.SkipCycles(remainingCycles);
+        m_SystemClockCounter += ticksToInstruction;
+        m_NextCpuTick = m_SystemClockCounter;
+    } else {
+        // Stop right before the event, the CPU ticks in between only count
+        // down the cycles of the current instruction
+        if (ticksToEvent > ticksToCpuTick) {
+            const uint32_t skippedCycles =
+                static_cast<uint32_t>((ticksToEvent - ticksToCpuTick + 2) / 3);
+            m_Cpu.SkipCycles(skippedCycles);
+            m_NextCpuTick += 3 * skippedCycles;
+        }
+        m_SystemClockCounter = eventTick;
+    }
+}
+
+bool Nes::DoDirectDmaTransfer() {
+    if (m_SystemClockCounter != m_NextCpuTick || !m_Dma.IsInWaitState()) {
+        return false;
+    }
+    const uint8_t* data = m_Dma.GetDirectSourcePage();
+    if (data == nullptr) {
+        return false;
+    }
+
+    // One CPU cycle waiting for an odd cycle, two if it starts on an even
+    // one, then a read and a write for each byte
+    const uint64_t cpuCycles = (m_SystemClockCounter % 2 == 1 ? 1 : 2) + 512;
+    const uint64_t lastTick = m_SystemClockCounter + 3 * (cpuCycles - 1);
+
+    // The ticks before the transfer see the previous OAM
+    m_Ppu.CatchUp(m_SystemClockCounter);
+    if (m_Scheduler.GetNextTimestamp() <= lastTick ||
+        m_Ppu.GetNextOamReadTimestamp() <= lastTick) {
+        return false;
+    }
+
+    m_Ppu.WriteOamPage(data);
+    m_Dma.FinishDirectTransfer();
+    m_SystemClockCounter = lastTick + 1;
+    m_NextCpuTick = lastTick + 3;
+    return true;
+}
+
+void Nes::ScheduleEvents() {
+    m_Scheduler.Clear();
+    m_Scheduler.Schedule(ScheduledEvent::VERTICAL_BLANK,
+                         m_Ppu.GetNextVerticalBlankTimestamp());
+    m_Scheduler.Schedule(ScheduledEvent::FRAME_END,
+                         m_Ppu.GetNextFrameEndTimestamp());
+    if (m_Dma.IsTranferInProgress()) {
+        m_Scheduler.Schedule(ScheduledEvent::DMA_TRANSFER,
+                             m_SystemClockCounter);
+    }
+}
+
+void Nes::RunEventTick() {
+    bool isPpuEventTick = false;
+    bool isDmaTick = false;
+    while (m_Scheduler.GetNextTimestamp() == m_SystemClockCounter) {
+        switch (m_Scheduler.PopNextEvent()) {
+            case ScheduledEvent::VERTICAL_BLANK:
+            case ScheduledEvent::FRAME_END:
+                isPpuEventTick = true;
+                break;
+            case ScheduledEvent::DMA_TRANSFER:
+                isDmaTick = true;
+                break;
+        }
+    }
+
+    // Every event of the tick is handled by a single tick of the whole
+    // system, unless the DMA can run its whole transfer at once
+    if (!isDmaTick || isPpuEventTick || !DoDirectDmaTransfer()) {
+        m_Ppu.CatchUp(m_SystemClockCounter);
+        Clock();
+    }
+
+    if (isPpuEventTick) {
+        m_Scheduler.Schedule(ScheduledEvent::VERTICAL_BLANK,
+                             m_Ppu.GetNextVerticalBlankTimestamp());
+        m_Scheduler.Schedule(ScheduledEvent::FRAME_END,
+                             m_Ppu.GetNextFrameEndTimestamp());
+    }
+    // Until the transfer ends, the DMA acts on every tick. A transfer
+    // started by the CPU during this tick starts on the next one as well.
+    if (m_Dma.IsTranferInProgress()) {
+        m_Scheduler.Schedule(ScheduledEvent::DMA_TRANSFER,
+                             m_SystemClockCounter);
+    }
+}
+
 void Nes::DoFrame() {
     if (!m_IsCartridgeLoaded) {
         return;
     }
-    do {
-        Clock();
-    } while (!m_Ppu.IsFrameCompleted());
+    if (m_RunAheadFrames > 0) {
+        RunAheadFrame();
+    } else {
+        RunFrame();
+    }
+}
+
+void Nes::SetRunAheadFrames(uint32_t frames) { m_RunAheadFrames = frames; }
+
+void Nes::RunAheadFrame() {
+    // Frame that the game really goes through, never displayed
+    m_Ppu.SetRenderingEnabled(false);
+    RunFrame();
+
+    const size_t stateSize = GetStateSize();
+    if (m_RunAheadState.size() != stateSize) {
+        m_RunAheadState.resize(stateSize);
+    }
+    SaveState(m_RunAheadState.data(), stateSize);
+
+    for (uint32_t frame = 1; frame <= m_RunAheadFrames; ++frame) {
+        m_Ppu.SetRenderingEnabled(frame == m_RunAheadFrames);
+        RunFrame();
+    }
+
+    LoadState(m_RunAheadState.data(), stateSize);
+}
+
+void Nes::RunFrame() {
+    if (m_ExecutionMode == ExecutionMode::CYCLE_STEPPED) {
+        do {
+            Clock();
+        } while (!m_Ppu.IsFrameCompleted());
+    } else {
+        // The CPU runs ahead of the PPU, which is only caught up by the bus
+        // when the CPU accesses it, and here on the ticks of the scheduled
+        // events
+        ScheduleEvents();
+        do {
+            const uint64_t eventTick = m_Scheduler.GetNextTimestamp();
+            if (m_SystemClockCounter == eventTick) {
+                RunEventTick();
+            } else if (m_SystemClockCounter == m_NextCpuTick &&
+                       m_Cpu.IsCurrentInstructionComplete()) {
+                // Within a tick the PPU runs first, so the instruction sees
+                // the PPU one tick later
+                ++m_SystemClockCounter;
+                m_NextCpuTick += 3;
+                m_Cpu.Clock();
+            } else {
+                SkipIdleTicks(eventTick);
+            }
+        } while (!m_Ppu.IsFrameCompleted());
+    }
 
     do {
         m_Cpu.Clock();
@@ -89,6 +248,10 @@ void Nes::DoFrame() {
     m_Ppu.StartNewFrame();
 }
 
+void Nes::SetExecutionMode(ExecutionMode mode) { m_ExecutionMode = mode; }
+
+Nes::ExecutionMode Nes::GetExecutionMode() const { return m_ExecutionMode; }
+
 bool Nes::IsCartridgeLoaded() const { return m_IsCartridgeLoaded; }
 
 uint8_t Nes::GetControllerState(size_t controllerIdx) const {
@@ -106,4 +269,102 @@ void Nes::WriteControllerState(size_t controllerIdx, uint8_t data) {
     m_Bus.WriteControllerState(controllerIdx, data);
 }
 
+uint64_t Nes::HashCompletedFrame() const {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(GetCompletedFrame());
+    uint64_t hash = 0xCBF29CE484222325;
+    for (size_t i = 0; i < 256 * 240 * sizeof(int); ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3;
+    }
+    return hash;
+}
+
+size_t Nes::GetStateSize() const {
+    StateWriter writer{nullptr};
+    WriteState(writer, 0);
+    return writer.GetOffset();
+}
+
+size_t Nes::GetMaxStateSize() const {
+    const size_t stateSize = GetStateSize();
+    if (m_Cartridge == nullptr) {
+        return stateSize;
+    }
+    return stateSize - m_Cartridge->GetStateSize() +
+           m_Cartridge->GetMaxStateSize();
+}
+
+bool Nes::SaveState(uint8_t* buffer, size_t size) const {
+    const size_t stateSize = GetStateSize();
+    if (buffer == nullptr || size < stateSize) {
+        return false;
+    }
+    StateWriter writer{buffer};
+    WriteState(writer, static_cast<uint32_t>(stateSize));
+    assert(writer.GetOffset() == stateSize);
+    return true;
+}
+
+bool Nes::LoadState(const uint8_t* buffer, size_t size) {
+    if (buffer == nullptr || size < sizeof(StateHeader)) {
+        return false;
+    }
+    StateReader reader{buffer};
+    StateHeader header;
+    reader.Read(header);
+    if (header.m_Magic != STATE_MAGIC || header.m_Version != STATE_VERSION ||
+        header.m_Size > size) {
+        return false;
+    }
+
+    // Only the size of the cartridge state can differ from the current one,
+    // depending on the copies of the ROM it holds
+    const size_t cartridgeStateSize = m_Cartridge != nullptr
+                                          ? m_Cartridge->GetStateSize()
+                                          : sizeof(CartridgeStateHeader);
+    const size_t otherStateSize =
+        GetStateSize() - sizeof(StateHeader) - cartridgeStateSize;
+    if (header.m_Size < sizeof(StateHeader) + otherStateSize) {
+        return false;
+    }
+    const size_t savedCartridgeStateSize =
+        header.m_Size - sizeof(StateHeader) - otherStateSize;
+    if (m_Cartridge != nullptr) {
+        if (!m_Cartridge->LoadState(reader, savedCartridgeStateSize)) {
+            return false;
+        }
+    } else if (savedCartridgeStateSize == sizeof(CartridgeStateHeader)) {
+        reader.ReadInPlace(sizeof(CartridgeStateHeader));
+    } else {
+        return false;
+    }
+    reader.Read(m_SystemClockCounter);
+    // The CPU ticks on the multiples of three
+    m_NextCpuTick = (m_SystemClockCounter + 2) / 3 * 3;
+    m_Cpu.LoadState(reader);
+    m_Bus.LoadState(reader);
+    m_Dma.LoadState(reader);
+    m_Ppu.LoadState(reader);
+    // States are saved between frames, where the PPU is up to date
+    m_Ppu.SetTimestamp(m_SystemClockCounter);
+    assert(reader.GetOffset() == header.m_Size);
+    return true;
+}
+
+void Nes::WriteState(StateWriter& writer, uint32_t stateSize) const {
+    StateHeader header;
+    header.m_Size = stateSize;
+    writer.Write(header);
+
+    if (m_Cartridge != nullptr) {
+        m_Cartridge->SaveState(writer);
+    } else {
+        writer.Write(CartridgeStateHeader{});
+    }
+    writer.Write(m_SystemClockCounter);
+    m_Cpu.SaveState(writer);
+    m_Bus.SaveState(writer);
+    m_Dma.SaveState(writer);
+    m_Ppu.SaveState(writer);
+}
+
 }  // namespace dearnes
@@ -0,0 +1,149 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/parallel_runner.h"
+
+using Nes = dearnes::Nes;
+
+namespace {
+
+struct Options {
+    std::string m_RomPath = "res/roms/nestest.nes";
+    size_t m_Instances = 0;
+    uint64_t m_Frames = 600;
+    uint64_t m_FramesPerBatch = 60;
+    std::vector<size_t> m_ThreadCounts;
+};
+
+void PrintUsage() {
+    fmt::print(
+        "Usage: dear_nes_parallel [rom] [--instances N] [--frames N] "
+        "[--batch N]\n"
+        "                         [--threads N,N,...]\n"
+        "\n"
+        "Runs N independent instances of the ROM on a work-stealing thread\n"
+        "pool once for each thread count, and reports the per-instance\n"
+        "results and the aggregate frame rate. By default the thread counts\n"
+        "are the powers of two up to the number of hardware threads, and\n"
+        "there are two instances per hardware thread.\n");
+}
+
+bool ParseThreadCounts(const std::string& text, std::vector<size_t>& counts) {
+    std::istringstream tokens{text};
+    std::string count;
+    while (std::getline(tokens, count, ',')) {
+        const size_t value = std::strtoull(count.c_str(), nullptr, 10);
+        if (value == 0) {
+            return false;
+        }
+        counts.push_back(value);
+    }
+    return !counts.empty();
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--instances" && hasValue) {
+            options.m_Instances = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--frames" && hasValue) {
+            options.m_Frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--batch" && hasValue) {
+            options.m_FramesPerBatch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && hasValue) {
+            if (!ParseThreadCounts(argv[++i], options.m_ThreadCounts)) {
+                return false;
+            }
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.m_RomPath = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.m_Frames > 0 && options.m_FramesPerBatch > 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    const size_t hardwareThreads =
+        std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if (options.m_Instances == 0) {
+        options.m_Instances = 2 * hardwareThreads;
+    }
+    if (options.m_ThreadCounts.empty()) {
+        for (size_t count = 1; count < hardwareThreads; count *= 2) {
+            options.m_ThreadCounts.push_back(count);
+        }
+        options.m_ThreadCounts.push_back(hardwareThreads);
+    }
+
+    std::vector<dearnes::EmulationJob> jobs(options.m_Instances);
+    for (dearnes::EmulationJob& job : jobs) {
+        job.m_RomPath = options.m_RomPath;
+        job.m_Frames = options.m_Frames;
+    }
+
+    fmt::print("ROM:              {}\n", options.m_RomPath);
+    fmt::print("Instances:        {} x {} frames, {} frames per batch\n",
+               options.m_Instances, options.m_Frames, options.m_FramesPerBatch);
+    fmt::print("Hardware threads: {}\n", hardwareThreads);
+
+    double singleThreadFps = 0.0;
+    for (size_t threadCount : options.m_ThreadCounts) {
+        std::vector<uint64_t> hashes(jobs.size());
+        dearnes::ParallelRunner runner{threadCount, options.m_FramesPerBatch};
+        const dearnes::ParallelRunSummary summary =
+            runner.Run(jobs, [&hashes](size_t jobIdx, Nes& nes) {
+                hashes[jobIdx] = nes.HashCompletedFrame();
+            });
+
+        fmt::print("\n{} thread(s)\n", threadCount);
+        fmt::print("  {:>8} {:>8} {:>8} {:>10} {:>10}  {}\n", "Instance",
+                   "Frames", "Batches", "Busy (s)", "FPS", "Last frame hash");
+        for (size_t i = 0; i < summary.m_Results.size(); ++i) {
+            const dearnes::EmulationResult& result = summary.m_Results[i];
+            if (!result.m_Success) {
+                fmt::print("  {:>8} failed to load the cartridge: {}\n", i,
+                           result.m_Error ==
+                                   dearnes::CartridgeLoaderError::FILE_NOT_FOUND
+                               ? "file not found"
+                               : "mapper not supported");
+                continue;
+            }
+            fmt::print("  {:>8} {:>8} {:>8} {:>10.3f} {:>10.2f}  {:016X}\n",
+                       i, result.m_FramesRun, result.m_Batches,
+                       result.m_BusySeconds,
+                       result.m_FramesRun / result.m_BusySeconds, hashes[i]);
+        }
+
+        const double fps = summary.m_TotalFrames / summary.m_WallSeconds;
+        if (singleThreadFps == 0.0) {
+            singleThreadFps = fps / threadCount;
+        }
+        const double speedup = fps / singleThreadFps;
+        fmt::print(
+            "  Aggregate: {:.2f} FPS in {:.3f} s, {:.2f}x speed-up, {:.0f}% "
+            "efficiency\n",
+            fps, summary.m_WallSeconds, speedup,
+            100.0 * speedup / threadCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/parallel_runner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <variant>
+
+#include "dear_nes_lib/cartridge_loader.h"
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/rom_image.h"
+
+namespace dearnes {
+
+struct ParallelRunner::Instance {
+    size_t m_JobIdx = 0;
+    const EmulationJob* m_Job = nullptr;
+    EmulationResult* m_Result = nullptr;
+    const FinishedCallback* m_OnFinished = nullptr;
+    // Shared by every instance of the same ROM, nullptr if it failed to load
+    std::shared_ptr<const RomImage> m_RomImage;
+    // Created by the first batch, so the instances are set up by the workers
+    std::unique_ptr<Nes> m_Nes;
+};
+
+ParallelRunner::ParallelRunner(size_t numThreads, uint64_t framesPerBatch)
+    : m_Pool(std::max<size_t>(numThreads, 1)),
+      m_FramesPerBatch(std::max<uint64_t>(framesPerBatch, 1)) {}
+
+ParallelRunSummary ParallelRunner::Run(const std::vector<EmulationJob>& jobs,
+                                       const FinishedCallback& onFinished) {
+    ParallelRunSummary summary;
+    summary.m_Results.resize(jobs.size());
+
+    // Every ROM is loaded once, whatever the number of instances running it
+    CartridgeLoader cartridgeLoader;
+    std::map<std::string, std::shared_ptr<const RomImage>> romImages;
+    std::vector<Instance> instances(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        auto romImage = romImages.find(jobs[i].m_RomPath);
+        if (romImage == romImages.end()) {
+            auto ret = cartridgeLoader.LoadRomImage(jobs[i].m_RomPath);
+            if (auto error = std::get_if<CartridgeLoaderError>(&ret)) {
+                summary.m_Results[i].m_Error = *error;
+                continue;
+            }
+            romImage =
+                romImages
+                    .emplace(jobs[i].m_RomPath,
+                             std::get<std::shared_ptr<const RomImage>>(ret))
+                    .first;
+        }
+        instances[i].m_RomImage = romImage->second;
+        instances[i].m_JobIdx = i;
+        instances[i].m_Job = &jobs[i];
+        instances[i].m_Result = &summary.m_Results[i];
+        instances[i].m_OnFinished = onFinished ? &onFinished : nullptr;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    for (Instance& instance : instances) {
+        if (instance.m_RomImage) {
+            m_Pool.Submit([this, &instance] { RunBatch(instance); });
+        }
+    }
+    m_Pool.Wait();
+    const auto endTime = std::chrono::steady_clock::now();
+
+    summary.m_WallSeconds =
+        std::chrono::duration<double>(endTime - startTime).count();
+    for (const EmulationResult& result : summary.m_Results) {
+        summary.m_TotalFrames += result.m_FramesRun;
+    }
+    return summary;
+}
+
+void ParallelRunner::RunBatch(Instance& instance) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const EmulationJob& job = *instance.m_Job;
+    EmulationResult& result = *instance.m_Result;
+
+    if (!instance.m_Nes) {
+        CartridgeLoader cartridgeLoader;
+        result.m_Success = true;
+        instance.m_Nes = std::make_unique<Nes>();
+        instance.m_Nes->InsertCatridge(
+            cartridgeLoader.CreateCartridge(instance.m_RomImage));
+    }
+
+    Nes& nes = *instance.m_Nes;
+    const uint64_t lastFrame =
+        std::min(job.m_Frames, result.m_FramesRun + m_FramesPerBatch);
+    for (; result.m_FramesRun < lastFrame; ++result.m_FramesRun) {
+        uint8_t buttons = 0x00;
+        if (!job.m_ControllerInput.empty()) {
+            buttons = job.m_ControllerInput[std::min<uint64_t>(
+                result.m_FramesRun, job.m_ControllerInput.size() - 1)];
+        }
+        nes.ClearControllerState(CONTROLLER_PLAYER_1_IDX);
+        nes.WriteControllerState(CONTROLLER_PLAYER_1_IDX, buttons);
+        nes.DoFrame();
+    }
+    ++result.m_Batches;
+
+    const bool isFinished = result.m_FramesRun >= job.m_Frames;
+    if (isFinished && instance.m_OnFinished) {
+        (*instance.m_OnFinished)(instance.m_JobIdx, nes);
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+    result.m_BusySeconds +=
+        std::chrono::duration<double>(endTime - startTime).count();
+
+    if (isFinished) {
+        instance.m_Nes.reset();
+        instance.m_RomImage.reset();
+    } else {
+        m_Pool.Submit([this, &instance] { RunBatch(instance); });
+    }
+}
+
+}  // namespace dearnes
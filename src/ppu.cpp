@@ -1,26 +1,272 @@
 // Copyright (c) 2020 Emmanuel Arias
 #include "dear_nes_lib/ppu.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 #include "dear_nes_lib/cartridge.h"
+#include "dear_nes_lib/save_state.h"
+#include "dear_nes_lib/tile_decoder.h"
 
 namespace dearnes {
 
-Ppu::Ppu() : m_OutputScreen{new int[256 * 240]} {}
+namespace {
+
+/// <summary>
+/// Groups of scanlines that run the same actions on the same cycles
+/// </summary>
+enum ScanlineType : uint8_t {
+    kPreRenderScanline = 0,       // -1
+    kFirstVisibleScanline,        // 0
+    kVisibleScanline,             // 1 to 239
+    kPostRenderScanline,          // 240
+    kVerticalBlankStartScanline,  // 241
+    kVerticalBlankScanline,       // 242 to 260
+    kScanlineTypeSize
+};
+
+constexpr size_t NUM_SCANLINES = 262;
+constexpr size_t NUM_CYCLES = 341;
+
+// Besides one bit per PpuAction, the flags of a cycle tell whether it outputs
+// a pixel, and whether it can raise a sprite zero hit
+constexpr uint16_t CYCLE_ACTIONS_MASK = (1 << kPpuActionSize) - 1;
+constexpr uint16_t CYCLE_DRAWS_PIXEL = 1 << kPpuActionSize;
+constexpr uint16_t CYCLE_CHECKS_SPRITE_ZERO = 1 << (kPpuActionSize + 1);
+
+constexpr ScanlineType GetScanlineType(int scanLine) {
+    if (scanLine == -1) {
+        return kPreRenderScanline;
+    } else if (scanLine == 0) {
+        return kFirstVisibleScanline;
+    } else if (scanLine < 240) {
+        return kVisibleScanline;
+    } else if (scanLine == 240) {
+        return kPostRenderScanline;
+    } else if (scanLine == 241) {
+        return kVerticalBlankStartScanline;
+    }
+    return kVerticalBlankScanline;
+}
+
+/// <summary>
+/// Flags of a cycle of a scanline. The actions of a cycle run in the order of
+/// the PpuAction enum.
+/// </summary>
+constexpr uint16_t GetCycleFlags(ScanlineType type, int cycle) {
+    uint16_t flags = 0;
+    auto Add = [&flags](PpuAction action) { flags |= 1 << action; };
+
+    if (type == kPreRenderScanline) {
+        if (cycle == 1) {
+            Add(kPrerenderClear);
+        } else if (cycle >= 280 && cycle < 305) {
+            Add(kPrerenderTransferY);
+        }
+    }
+    if (type == kFirstVisibleScanline && cycle == 0) {
+        Add(kRenderSkipOdd);
+    }
+    const bool isVisibleScanline =
+        type == kFirstVisibleScanline || type == kVisibleScanline;
+    if (type == kPreRenderScanline || isVisibleScanline) {
+        if ((cycle >= 2 && cycle < 258) || (cycle >= 321 && cycle < 338)) {
+            Add(kRenderProcessNextTile);
+        }
+        if (cycle == 256) {
+            Add(kRenderIncrementScrollY);
+        }
+        if (cycle == 257) {
+            Add(kRenderLoadShiftersAndTransferX);
+        }
+        if (cycle == 338 || cycle == 340) {
+            Add(kRenderLoadNextBackgroundTile);
+        }
+        if (cycle == 257 && isVisibleScanline) {
+            Add(kRenderDoOAMTransfer);
+        }
+        if (cycle == 340) {
+            Add(kRenderUpdateSprites);
+        }
+    }
+    if (type == kVerticalBlankStartScanline && cycle == 1) {
+        Add(kRenderEndFrameRendering);
+    }
+
+    if (isVisibleScanline && cycle >= 1 && cycle <= 256) {
+        flags |= CYCLE_DRAWS_PIXEL;
+    }
+    if (cycle >= 1 && cycle < 258) {
+        flags |= CYCLE_CHECKS_SPRITE_ZERO;
+    }
+    return flags;
+}
 
-Ppu::~Ppu() { delete[] m_OutputScreen; }
+struct CycleTable {
+    ScanlineType m_ScanlineTypes[NUM_SCANLINES] = {};
+    uint16_t m_CycleFlags[kScanlineTypeSize][NUM_CYCLES] = {};
+};
+
+constexpr CycleTable MakeCycleTable() {
+    CycleTable table;
+    for (size_t scanLine = 0; scanLine < NUM_SCANLINES; ++scanLine) {
+        table.m_ScanlineTypes[scanLine] =
+            GetScanlineType(static_cast<int>(scanLine) - 1);
+    }
+    for (size_t type = 0; type < kScanlineTypeSize; ++type) {
+        for (size_t cycle = 0; cycle < NUM_CYCLES; ++cycle) {
+            table.m_CycleFlags[type][cycle] = GetCycleFlags(
+                static_cast<ScanlineType>(type), static_cast<int>(cycle));
+        }
+    }
+    return table;
+}
+
+/// <summary>
+/// Flags of every cycle, indexed by the type of the scanline (scanline + 1)
+/// and the cycle. Replaces testing the scanline and cycle ranges on every
+/// tick.
+/// </summary>
+constexpr CycleTable CYCLE_TABLE = MakeCycleTable();
+
+// Ticks of the frame that can affect the CPU, numbered from the first cycle
+// of the pre-render scanline: the start of the vertical blank (scanline 241,
+// cycle 1) and the last tick of the frame
+constexpr uint32_t VERTICAL_BLANK_START_TICK = (241 + 1) * NUM_CYCLES + 1;
+constexpr uint32_t FRAME_END_TICK = NUM_SCANLINES * NUM_CYCLES - 1;
+
+// Ticks of the frame where the sprites of the next scanline are evaluated from
+// the OAM: the cycle 257 of the first and the last visible scanlines
+constexpr uint32_t FIRST_OAM_READ_TICK = (0 + 1) * NUM_CYCLES + 257;
+constexpr uint32_t LAST_OAM_READ_TICK = (239 + 1) * NUM_CYCLES + 257;
+
+// Cycles of a visible scanline drawn at once by Ppu::RenderScanline, from the
+// cycle 1, and number of 8 pixel tiles they draw
+constexpr int32_t SCANLINE_SPAN_CYCLES = 256;
+constexpr size_t SCANLINE_SPAN_TILES = 32;
+
+// Pixels of the sprite line drawn by Ppu::BuildSpriteLine: the 2 bit pixel,
+// the 2 bit palette, whether the sprite is in front of the background, and
+// whether it is the first sprite of the scanline
+constexpr uint8_t SPRITE_LINE_PIXEL_MASK = 0x03;
+constexpr uint8_t SPRITE_LINE_PALETTE_SHIFT = 2;
+constexpr uint8_t SPRITE_LINE_IN_FRONT = 0x10;
+constexpr uint8_t SPRITE_LINE_SPRITE_ZERO = 0x20;
+
+constexpr uint8_t MASK_EMPHASIS_BITS = 0xE0;
+constexpr uint8_t MASK_COLOR_BITS = MASK_EMPHASIS_BITS | (1 << GRAYSCALE);
+
+// Colors of the NES palette, in format ARGB
+// Table taken from https://wiki.nesdev.com/w/index.php/PPU_palettes
+constexpr uint32_t PALETTE_COLORS[0x40] = {
+    0xFF545454, 0xFF001E74, 0xFF081090, 0xFF300088, 0xFF440064, 0xFF5C0030,
+    0xFF540400, 0xFF3C1800, 0xFF202A00, 0xFF083A00, 0xFF004000, 0xFF003C00,
+    0xFF00323C, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF989698, 0xFF084CC4,
+    0xFF3032EC, 0xFF5C1EE4, 0xFF8814B0, 0xFFA01464, 0xFF982220, 0xFF783C00,
+    0xFF545A00, 0xFF287200, 0xFF087C00, 0xFF007628, 0xFF006678, 0xFF000000,
+    0xFF000000, 0xFF000000, 0xFFECEEEC, 0xFF4C9AEC, 0xFF787CEC, 0xFFB062EC,
+    0xFFE454EC, 0xFFEC58B4, 0xFFEC6A64, 0xFFD48820, 0xFFA0AA00, 0xFF74C400,
+    0xFF4CD020, 0xFF38CC6C, 0xFF38B4CC, 0xFF3C3C3C, 0xFF000000, 0xFF000000,
+    0xFFECEEEC, 0xFFA8CCEC, 0xFFBCBCEC, 0xFFD4B2EC, 0xFFECAEEC, 0xFFECAED4,
+    0xFFECD4AE, 0xFFE4C490, 0xFFCCD278, 0xFFB4DE78, 0xFFA8E290, 0xFF98E2B4,
+    0xFFA0D6E4, 0xFFA0A2A0, 0xFF000000, 0xFF000000};
+
+/// <summary>
+/// Darken the color channels that are not emphasized by the mask register.
+/// The bits are, from lowest to highest, red, green and blue.
+/// </summary>
+constexpr uint32_t ApplyEmphasis(uint32_t color, uint8_t emphasis) {
+    if (emphasis == 0) {
+        return color;
+    }
+    for (int channel = 0; channel < 3; ++channel) {
+        // ARGB: red is the third byte, blue the first one
+        const int shift = 16 - channel * 8;
+        if (emphasis & ~(1 << channel)) {
+            const uint32_t value = (color >> shift) & 0xFF;
+            color = (color & ~(0xFFu << shift)) | ((value * 3 / 4) << shift);
+        }
+    }
+    return color;
+}
+
+/// <summary>
+/// ARGB color of every indexed color, see Ppu::GetIndexedScreen
+/// </summary>
+constexpr std::array<uint32_t, 0x200> MakeIndexedColors() {
+    std::array<uint32_t, 0x200> colors = {};
+    for (size_t index = 0; index < colors.size(); ++index) {
+        colors[index] = ApplyEmphasis(PALETTE_COLORS[index & 0x3F],
+                                      static_cast<uint8_t>(index >> 6));
+    }
+    return colors;
+}
+
+constexpr std::array<uint32_t, 0x200> INDEXED_COLORS = MakeIndexedColors();
+
+}  // namespace
+
+Ppu::Ppu()
+    : m_BackScreen{new uint16_t[256 * 240]()},
+      m_FrontScreen{new uint16_t[256 * 240]()},
+      m_OutputScreen{new int[256 * 240]} {
+    UpdatePageTable();
+    ResolvePalette();
+}
+
+Ppu::~Ppu() {
+    delete[] m_BackScreen;
+    delete[] m_FrontScreen;
+    delete[] m_OutputScreen;
+}
 
 int Ppu::GetColorFromPalette(uint8_t palette, uint8_t pixel) {
     assert(pixel <= 3);
-    uint8_t data = PpuRead(0x3F00 + (palette << 2) + pixel) & 0x3F;
+    return static_cast<int>(
+        INDEXED_COLORS[m_ResolvedPalette[((palette << 2) + pixel) & 0x1F]]);
+}
+
+void Ppu::ResolvePalette() {
+    for (uint8_t entry = 0; entry < 32; ++entry) {
+        ResolvePaletteEntry(entry);
+    }
+}
+
+void Ppu::ResolvePaletteEntry(uint8_t entry) {
+    const uint8_t colorIdx =
+        PpuRead(0x3F00 + entry) & (m_MaskReg.GetField(GRAYSCALE) ? 0x30 : 0x3F);
+    const uint8_t emphasis = m_MaskReg.GetRegister() >> ENHANCE_RED;
+    m_ResolvedPalette[entry] = static_cast<uint16_t>(colorIdx | emphasis << 6);
+}
+
+const int* Ppu::GetOutputScreen() const {
+    if (m_IsOutputScreenStale) {
+        ConvertToArgb(m_FrontScreen, 256 * 240, m_OutputScreen);
+        m_IsOutputScreenStale = false;
+    }
+    return m_OutputScreen;
+}
 
-    return m_PalScreen[data];
+void Ppu::ClearOutputScreen() {
+    std::fill_n(m_FrontScreen, 256 * 240, uint16_t{0});
+    std::fill_n(m_BackScreen, 256 * 240, uint16_t{0});
+    m_IsOutputScreenStale = true;
+    ++m_CompletedFrameCount;
 }
 
-const int* Ppu::GetOutputScreen() const { return m_OutputScreen; }
+void Ppu::ConvertToArgb(const uint16_t* indexedPixels, size_t count,
+                        int* argbPixels) {
+    // One lookup per pixel in a 2 KB table that stays in the L1 cache. SSE2
+    // has no gather instruction, and the AVX2 one is not faster than
+    // separate loads for this, so the loop is left to the compiler.
+    for (size_t i = 0; i < count; ++i) {
+        argbPixels[i] =
+            static_cast<int>(INDEXED_COLORS[indexedPixels[i] & 0x1FF]);
+    }
+}
 
 bool Ppu::IsFrameCompleted() const { return m_FrameIsCompleted; }
 
@@ -73,7 +319,12 @@ void Ppu::CpuWrite(uint16_t address, uint8_t data) {
                 m_ControlReg.GetField(ControlRegisterFields::NAMETABLE_Y);
             break;
         case 0x0001:  // mask
-            m_MaskReg.SetRegister(data);
+            if ((m_MaskReg.GetRegister() ^ data) & MASK_COLOR_BITS) {
+                m_MaskReg.SetRegister(data);
+                ResolvePalette();
+            } else {
+                m_MaskReg.SetRegister(data);
+            }
             break;
         case 0x0002:  // Status
             break;
@@ -81,7 +332,7 @@ void Ppu::CpuWrite(uint16_t address, uint8_t data) {
             m_OAMAddress = data;
             break;
         case 0x0004:  // OAM data
-            m_OAMPtr[m_OAMAddress] = data;
+            WriteOam(m_OAMAddress, data);
             break;
         case 0x0005:  // Scroll
             if (m_AddressLatch == 0x00) {
@@ -118,11 +369,134 @@ void Ppu::CpuWrite(uint16_t address, uint8_t data) {
 void Ppu::ConnectCatridge(Cartridge* cartridge) {
     // Logger::Get().Log("PPU", "Connecting cartridge");
     m_Cartridge = cartridge;
+    // The memory of the new cartridge may reuse the addresses of the old one
+    m_ChrTileCache.InvalidateAll();
+    UpdatePageTable();
+}
+
+void Ppu::SaveState(StateWriter& writer) const {
+    writer.Write(m_Nametables);
+    writer.Write(m_PaletteTable);
+    writer.Write(m_PatternTables);
+    writer.Write(m_VramAddress);
+    writer.Write(m_TramAddress);
+    writer.Write(m_FineX);
+    writer.Write(m_ScanLine);
+    writer.Write(m_Cycle);
+    writer.Write(m_StatusReg);
+    writer.Write(m_MaskReg);
+    writer.Write(m_ControlReg);
+    writer.Write(m_AddressLatch);
+    writer.Write(m_PpuDataBuffer);
+    writer.Write(m_NextBackgroundTileInfo);
+    writer.Write(m_BackgroundShifter);
+    writer.Write(m_OAM);
+    writer.Write(m_OAMAddress);
+    writer.Write(m_SpriteScanLine);
+    writer.Write(m_SpriteCount);
+    // Stored as bitplanes, as the PPU loads them
+    uint8_t spriteShifterPatternLo[8];
+    uint8_t spriteShifterPatternHi[8];
+    for (size_t i = 0; i < 8; ++i) {
+        ChrTileCache::EncodeRow(m_SpriteShifterPatterns[i],
+                                spriteShifterPatternLo[i],
+                                spriteShifterPatternHi[i]);
+    }
+    writer.Write(spriteShifterPatternLo);
+    writer.Write(spriteShifterPatternHi);
+    writer.Write(m_SpriteZeroHitPossible);
+    writer.Write(m_SpriteZeroBeingRendered);
+    writer.Write(m_FrameIsCompleted);
+    writer.Write(m_DoNMI);
+}
+
+void Ppu::LoadState(StateReader& reader) {
+    reader.Read(m_Nametables);
+    reader.Read(m_PaletteTable);
+    reader.Read(m_PatternTables);
+    reader.Read(m_VramAddress);
+    reader.Read(m_TramAddress);
+    reader.Read(m_FineX);
+    reader.Read(m_ScanLine);
+    reader.Read(m_Cycle);
+    reader.Read(m_StatusReg);
+    reader.Read(m_MaskReg);
+    reader.Read(m_ControlReg);
+    reader.Read(m_AddressLatch);
+    reader.Read(m_PpuDataBuffer);
+    reader.Read(m_NextBackgroundTileInfo);
+    reader.Read(m_BackgroundShifter);
+    reader.Read(m_OAM);
+    m_AreSpriteListsStale = true;
+    reader.Read(m_OAMAddress);
+    reader.Read(m_SpriteScanLine);
+    reader.Read(m_SpriteCount);
+    uint8_t spriteShifterPatternLo[8];
+    uint8_t spriteShifterPatternHi[8];
+    reader.Read(spriteShifterPatternLo);
+    reader.Read(spriteShifterPatternHi);
+    for (size_t i = 0; i < 8; ++i) {
+        m_SpriteShifterPatterns[i] = DecodeTileRow(spriteShifterPatternLo[i],
+                                                   spriteShifterPatternHi[i]);
+    }
+    reader.Read(m_SpriteZeroHitPossible);
+    reader.Read(m_SpriteZeroBeingRendered);
+    reader.Read(m_FrameIsCompleted);
+    reader.Read(m_DoNMI);
+    // The character memory was restored too
+    m_ChrTileCache.InvalidateAll();
+    UpdatePageTable();
+    ResolvePalette();
+}
+
+void Ppu::UpdatePageTable() {
+    m_ReadPages.fill(nullptr);
+
+    // $0000-$1FFF: pattern tables. Without a cartridge mapping, the internal
+    // pattern tables are used
+    constexpr uint8_t patternTablePages = 0x2000 >> PPU_PAGE_SHIFT;
+    for (uint8_t page = 0; page < patternTablePages; ++page) {
+        const uint8_t* cartridgePage =
+            m_Cartridge ? m_Cartridge->GetPpuReadPage(page) : nullptr;
+        if (cartridgePage != nullptr) {
+            m_ReadPages[page] = cartridgePage;
+        } else if (m_Cartridge == nullptr) {
+            m_ReadPages[page] = &m_PatternTables[page >> 2][(page & 0x03) *
+                                                           SIZE_PPU_PAGE];
+        }
+        m_ChrTileCache.SetPage(page, m_ReadPages[page]);
+    }
+
+    if (m_Cartridge == nullptr) {
+        return;
+    }
+
+    // $2000-$3BFF: nametables and their mirrors. The page $3C00-$3FFF also
+    // holds the palettes, so it is left to the handler
+    const auto mirroringMode = m_Cartridge->GetMirroringMode();
+    constexpr uint8_t firstNametablePage = 0x2000 >> PPU_PAGE_SHIFT;
+    constexpr uint8_t lastNametablePage = 0x3C00 >> PPU_PAGE_SHIFT;
+    for (uint8_t page = firstNametablePage; page < lastNametablePage; ++page) {
+        const uint8_t nametableIdx = page & 0x03;
+        if (mirroringMode == CartridgeHeader::MIRRORING_MODE::VERTICAL) {
+            m_ReadPages[page] = m_Nametables[nametableIdx & 0x01];
+        } else if (mirroringMode ==
+                   CartridgeHeader::MIRRORING_MODE::HORIZONTAL) {
+            m_ReadPages[page] = m_Nametables[nametableIdx >> 1];
+        }
+    }
 }
 
 uint8_t Ppu::PpuRead(uint16_t address, bool readOnly) {
-    uint8_t data = 0x00;
     address &= 0x3FFF;
+    if (const uint8_t* page = m_ReadPages[address >> PPU_PAGE_SHIFT]) {
+        return page[address & (SIZE_PPU_PAGE - 1)];
+    }
+    return PpuReadHandler(address);
+}
+
+uint8_t Ppu::PpuReadHandler(uint16_t address) {
+    uint8_t data = 0x00;
 
     if (m_Cartridge && m_Cartridge->PpuRead(address, data)) {
     } else if (address >= 0x0000 && address <= 0x1FFF) {
@@ -167,8 +541,15 @@ uint8_t Ppu::PpuRead(uint16_t address, bool readOnly) {
 void Ppu::PpuWrite(uint16_t address, uint8_t data) {
     address &= 0x3FFF;
     if (m_Cartridge && m_Cartridge->PpuWrite(address, data)) {
+        if (m_Cartridge->ConsumeMappingChanged()) {
+            UpdatePageTable();
+        }
+        if (address <= 0x1FFF) {
+            m_ChrTileCache.InvalidateTile(address);
+        }
     } else if (address >= 0x0000 && address <= 0x1FFF) {
         m_PatternTables[(address & 0x1000) >> 12][address & 0x0FFF] = data;
+        m_ChrTileCache.InvalidateTile(address);
     } else if (address >= 0x2000 && address <= 0x3EFF) {
         address &= 0x0FFF;
         if (m_Cartridge && m_Cartridge->GetMirroringMode() ==
@@ -202,6 +583,11 @@ void Ppu::PpuWrite(uint16_t address, uint8_t data) {
         if (address == 0x0018) address = 0x0008;
         if (address == 0x001C) address = 0x000C;
         m_PaletteTable[address] = data;
+        ResolvePaletteEntry(address);
+        if ((address & 0x03) == 0) {
+            // Shared by the background and sprite palettes
+            ResolvePaletteEntry(address | 0x10);
+        }
     }
 }
 
@@ -213,17 +599,20 @@ void Ppu::UpdateShifters() {
         m_BackgroundShifter.attributeHi <<= 1;
     }
     if (m_MaskReg.GetField(RENDER_SPRITES) && m_Cycle >= 0 && m_Cycle < 258) {
-        for (int i = 0; i < m_SpriteCount; ++i) {
-            if (m_SpriteScanLine[i].x > 0) {
-                --m_SpriteScanLine[i].x;
-            } else {
-                m_SpriteShifterPatternLo[i] <<= 1;
-                m_SpriteShifterPatternHi[i] <<= 1;
-            }
-        }
+        UpdateSpriteShifters();
     }
 };
 
+void Ppu::UpdateSpriteShifters() {
+    for (int i = 0; i < m_SpriteCount; ++i) {
+        if (m_SpriteScanLine[i].x > 0) {
+            --m_SpriteScanLine[i].x;
+        } else {
+            m_SpriteShifterPatterns[i] <<= 2;
+        }
+    }
+}
+
 void Ppu::LoadBackgroundShifters() {
     m_BackgroundShifter.patternLo =
         (m_BackgroundShifter.patternLo & 0xFF00) | m_NextBackgroundTileInfo.lsb;
@@ -238,6 +627,35 @@ void Ppu::LoadBackgroundShifters() {
         ((m_NextBackgroundTileInfo.attribute & 0b10) ? 0xFF : 0x00);
 };
 
+void Ppu::FetchNextTileId() {
+    m_NextBackgroundTileInfo.id =
+        PpuRead(0x2000 | (m_VramAddress.reg & 0x0FFF));
+}
+
+void Ppu::FetchNextTileAttribute() {
+    m_NextBackgroundTileInfo.attribute =
+        PpuRead(0x23C0 | (m_VramAddress.nametable_y << 11) |
+                (m_VramAddress.nametable_x << 10) |
+                ((m_VramAddress.coarse_y >> 2) << 3) |
+                (m_VramAddress.coarse_x >> 2));
+    if (m_VramAddress.coarse_y & 0x02) m_NextBackgroundTileInfo.attribute >>= 4;
+    if (m_VramAddress.coarse_x & 0x02) m_NextBackgroundTileInfo.attribute >>= 2;
+    m_NextBackgroundTileInfo.attribute &= 0x03;
+}
+
+void Ppu::FetchNextTilePattern(uint8_t plane) {
+    const uint8_t data = PpuRead(
+        (m_ControlReg.GetField(ControlRegisterFields::PATTERN_BACKGROUND)
+         << 12) +
+        ((uint16_t)m_NextBackgroundTileInfo.id << 4) +
+        (m_VramAddress.fine_y + plane * 8));
+    if (plane == 0) {
+        m_NextBackgroundTileInfo.lsb = data;
+    } else {
+        m_NextBackgroundTileInfo.msb = data;
+    }
+}
+
 void Ppu::IncrementScrollX() {
     if (m_MaskReg.GetField(MaskRegisterFields::RENDER_BACKGROUND) ||
         m_MaskReg.GetField(MaskRegisterFields::RENDER_SPRITES)) {
@@ -266,48 +684,6 @@ bool Ppu::NeedsToDoNMI() {
     return false;
 }
 
-size_t Ppu::GetNextActions(std::array<PpuAction, 3>& nextActions) {
-    size_t arrIndex = 0;
-    if (const bool isPreRenderScanline = m_ScanLine == -1;
-        isPreRenderScanline) {
-        if (m_Cycle == 1) {
-            nextActions[arrIndex++] = PpuAction::kPrerenderClear;
-        } else if (m_Cycle >= 280 && m_Cycle < 305) {
-            nextActions[arrIndex++] = PpuAction::kPrerenderTransferY;
-        }
-    }
-    if (m_ScanLine == 0 && m_Cycle == 0) {
-        nextActions[arrIndex++] = PpuAction::kRenderSkipOdd;
-    }
-    if (const bool isRenderScanline = m_ScanLine >= -1 && m_ScanLine < 240;
-        isRenderScanline) {
-        if ((m_Cycle >= 2 && m_Cycle < 258) ||
-            (m_Cycle >= 321 && m_Cycle < 338)) {
-            nextActions[arrIndex++] = PpuAction::kRenderProcessNextTile;
-        }
-        if (m_Cycle == 256) {
-            nextActions[arrIndex++] = PpuAction::kRenderIncrementScrollY;
-        }
-        if (m_Cycle == 257) {
-            nextActions[arrIndex++] =
-                PpuAction::kRenderLoadShiftersAndTransferX;
-        }
-        if (m_Cycle == 338 || m_Cycle == 340) {
-            nextActions[arrIndex++] = PpuAction::kRenderLoadNextBackgroundTile;
-        }
-        if (m_Cycle == 257 && m_ScanLine >= 0) {
-            nextActions[arrIndex++] = PpuAction::kRenderDoOAMTransfer;
-        }
-        if (m_Cycle == 340) {
-            nextActions[arrIndex++] = PpuAction::kRenderUpdateSprites;
-        }
-    }
-    if (m_ScanLine == 241 && m_Cycle == 1) {  // covered
-        nextActions[arrIndex++] = PpuAction::kRenderEndFrameRendering;
-    }
-    return arrIndex;
-}
-
 std::pair<uint8_t, uint8_t> Ppu::GetCurrentPixelToRender() {
     uint8_t bgPixel = 0x00;
     uint8_t bgPalette = 0x00;
@@ -323,18 +699,44 @@ std::pair<uint8_t, uint8_t> Ppu::GetCurrentPixelToRender() {
         uint8_t bg_pal1 = (m_BackgroundShifter.attributeHi & bitMux) > 0;
         bgPalette = (bg_pal1 << 1) | bg_pal0;
     }
+    return ComposePixel(bgPixel, bgPalette);
+}
+
+uint16_t Ppu::FetchNextTileRow() {
+    const uint16_t address =
+        (m_ControlReg.GetField(ControlRegisterFields::PATTERN_BACKGROUND)
+         << 12) +
+        ((uint16_t)m_NextBackgroundTileInfo.id << 4);
+    if (const ChrTileCache::Tile* tile = m_ChrTileCache.GetTile(address)) {
+        return tile->m_Rows[m_VramAddress.fine_y];
+    }
+    FetchNextTilePattern(0);
+    FetchNextTilePattern(1);
+    return DecodeTileRow(m_NextBackgroundTileInfo.lsb,
+                         m_NextBackgroundTileInfo.msb);
+}
+
+void Ppu::WriteOam(uint8_t address, uint8_t data) {
+    m_OAMPtr[address] = data;
+    m_AreSpriteListsStale = true;
+}
+
+void Ppu::WriteOamPage(const uint8_t* data) {
+    std::memcpy(m_OAM, data, sizeof(m_OAM));
+    m_AreSpriteListsStale = true;
+}
 
+std::pair<uint8_t, uint8_t> Ppu::ComposePixel(uint8_t bgPixel,
+                                              uint8_t bgPalette) {
     uint8_t fg_pixel = 0x00;
     uint8_t fg_palette = 0x00;
-    uint8_t fg_priority = 0x00;
+    bool fg_priority = false;
 
     if (m_MaskReg.GetField(RENDER_SPRITES)) {
         m_SpriteZeroBeingRendered = false;
         for (uint8_t i = 0; i < m_SpriteCount; ++i) {
             if (m_SpriteScanLine[i].x == 0) {
-                uint8_t pixelLo = (m_SpriteShifterPatternLo[i] & 0x80) > 0;
-                uint8_t pixelHi = (m_SpriteShifterPatternHi[i] & 0x80) > 0;
-                fg_pixel = (pixelHi << 1) | pixelLo;
+                fg_pixel = m_SpriteShifterPatterns[i] >> 14;
 
                 fg_palette = (m_SpriteScanLine[i].attribute & 0x03) + 0x04;
                 fg_priority = (m_SpriteScanLine[i].attribute & 0x20) == 0;
@@ -348,22 +750,27 @@ std::pair<uint8_t, uint8_t> Ppu::GetCurrentPixelToRender() {
             }
         }
     }
+    return MixPixels(bgPixel, bgPalette, fg_pixel, fg_palette, fg_priority);
+}
 
+std::pair<uint8_t, uint8_t> Ppu::MixPixels(uint8_t bgPixel, uint8_t bgPalette,
+                                           uint8_t fgPixel, uint8_t fgPalette,
+                                           bool isFgInFront) {
     uint8_t pixel = 0x00;
     uint8_t palette = 0x00;
 
-    if (bgPixel == 0 && fg_pixel == 0) {
+    if (bgPixel == 0 && fgPixel == 0) {
         pixel = palette = 0;
-    } else if (bgPixel == 0 && fg_pixel > 0) {
-        pixel = fg_pixel;
-        palette = fg_palette;
-    } else if (bgPixel > 0 && fg_pixel == 0) {
+    } else if (bgPixel == 0 && fgPixel > 0) {
+        pixel = fgPixel;
+        palette = fgPalette;
+    } else if (bgPixel > 0 && fgPixel == 0) {
         pixel = bgPixel;
         palette = bgPalette;
     } else {
-        if (fg_priority) {
-            pixel = fg_pixel;
-            palette = fg_palette;
+        if (isFgInFront) {
+            pixel = fgPixel;
+            palette = fgPalette;
         } else {
             pixel = bgPixel;
             palette = bgPalette;
@@ -406,24 +813,35 @@ void Ppu::Clock() {
             &Ppu::DoPpuActionRenderEndFrameRendering,
         };
 
-    std::array<PpuAction, 3> nextActions;
-    size_t actions = GetNextActions(nextActions);
+    const ScanlineType scanlineType =
+        CYCLE_TABLE.m_ScanlineTypes[m_ScanLine + 1];
+    const uint16_t cycleFlags =
+        CYCLE_TABLE.m_CycleFlags[scanlineType][m_Cycle];
 
-    for (int i = 0; i < actions; ++i) {
-        size_t actionCallbackIndex = static_cast<size_t>(nextActions[i]);
-        (this->*ppuActionsCallbackFunctions[actionCallbackIndex])();
+    uint16_t actions = cycleFlags & CYCLE_ACTIONS_MASK;
+    if (actions == 1 << kRenderProcessNextTile) {
+        // Most of the cycles of the rendering scanlines
+        DoPpuActionRenderProcessNextTile();
+    } else {
+        for (size_t i = 0; actions != 0; ++i, actions >>= 1) {
+            if (actions & 0x01) {
+                (this->*ppuActionsCallbackFunctions[i])();
+            }
+        }
     }
 
-    auto [pixel, palette] = GetCurrentPixelToRender();
+    if (m_IsRenderingEnabled && (cycleFlags & CYCLE_DRAWS_PIXEL)) {
+        auto [pixel, palette] = GetCurrentPixelToRender();
 
-    const int x = static_cast<int>(m_Cycle - 1);
-    const int y = static_cast<int>(m_ScanLine);
-    const int color = GetColorFromPalette(palette, pixel);
-    if (x >= 0 && x < 256 && y >= 0 && y < 240) {
-        const int position = (y * 256) + x;
-        m_OutputScreen[position] = color;
+        const int position = (m_ScanLine * 256) + (m_Cycle - 1);
+        m_BackScreen[position] = m_ResolvedPalette[(palette << 2) | pixel];
+    } else if (m_SpriteZeroHitPossible &&
+               (cycleFlags & CYCLE_CHECKS_SPRITE_ZERO)) {
+        // The pixel is not needed, only the sprite zero hit check
+        GetCurrentPixelToRender();
     }
 
+    ++m_Timestamp;
     ++m_Cycle;
     if (m_Cycle >= 341) {
         m_Cycle = 0;
@@ -431,10 +849,208 @@ void Ppu::Clock() {
         if (m_ScanLine >= 261) {
             m_ScanLine = -1;
             m_FrameIsCompleted = true;
+            if (m_IsRenderingEnabled) {
+                // Frames that are not drawn keep the previous one on display
+                std::swap(m_BackScreen, m_FrontScreen);
+                m_IsOutputScreenStale = true;
+                ++m_CompletedFrameCount;
+            }
+        }
+    }
+}
+
+void Ppu::CatchUp(uint64_t timestamp) {
+    // Signed, the PPU can be one tick ahead
+    int64_t ticks = static_cast<int64_t>(timestamp - m_Timestamp);
+    while (ticks > 0) {
+        if (m_Cycle == 1 && m_ScanLine >= 0 && m_ScanLine < 240 &&
+            ticks >= SCANLINE_SPAN_CYCLES) {
+            RenderScanline();
+            ticks -= SCANLINE_SPAN_CYCLES;
+        } else {
+            Clock();
+            --ticks;
         }
     }
 }
 
+void Ppu::RenderScanline() {
+    const bool isBackgroundEnabled = m_MaskReg.GetField(RENDER_BACKGROUND);
+    const bool areSpritesEnabled = m_MaskReg.GetField(RENDER_SPRITES);
+
+    // Pixels that go through the background shifters, one row of 2 bit
+    // pixels per tile (see ChrTileCache::Tile): the two tiles already loaded,
+    // then the tiles loaded on the cycles 9, 17, ..., 249. The attributes are
+    // kept as bits, like in the shifters.
+    uint16_t patternRows[SCANLINE_SPAN_TILES + 1];
+    uint8_t attributeLo[SCANLINE_SPAN_TILES + 1];
+    uint8_t attributeHi[SCANLINE_SPAN_TILES + 1];
+    patternRows[0] = DecodeTileRow(m_BackgroundShifter.patternLo >> 8,
+                                   m_BackgroundShifter.patternHi >> 8);
+    patternRows[1] = DecodeTileRow(m_BackgroundShifter.patternLo & 0xFF,
+                                   m_BackgroundShifter.patternHi & 0xFF);
+    attributeLo[0] = m_BackgroundShifter.attributeLo >> 8;
+    attributeLo[1] = m_BackgroundShifter.attributeLo & 0xFF;
+    attributeHi[0] = m_BackgroundShifter.attributeHi >> 8;
+    attributeHi[1] = m_BackgroundShifter.attributeHi & 0xFF;
+
+    // Same fetches as DoPpuActionRenderProcessNextTile, tile by tile
+    uint16_t nextTileRow = 0;
+    for (size_t tile = 0; tile < SCANLINE_SPAN_TILES; ++tile) {
+        if (tile > 0) {
+            patternRows[tile + 1] = nextTileRow;
+            attributeLo[tile + 1] =
+                (m_NextBackgroundTileInfo.attribute & 0b01) ? 0xFF : 0x00;
+            attributeHi[tile + 1] =
+                (m_NextBackgroundTileInfo.attribute & 0b10) ? 0xFF : 0x00;
+            FetchNextTileId();
+        }
+        FetchNextTileAttribute();
+        nextTileRow = FetchNextTileRow();
+        IncrementScrollX();
+    }
+    DoPpuActionRenderIncrementScrollY();
+
+    // The bitplanes of the cached rows were not read, only the ones left in
+    // the registers are needed
+    ChrTileCache::EncodeRow(nextTileRow, m_NextBackgroundTileInfo.lsb,
+                            m_NextBackgroundTileInfo.msb);
+    uint8_t lastPatternLo[2];
+    uint8_t lastPatternHi[2];
+    for (size_t i = 0; i < 2; ++i) {
+        ChrTileCache::EncodeRow(patternRows[SCANLINE_SPAN_TILES - 1 + i],
+                                lastPatternLo[i], lastPatternHi[i]);
+    }
+
+    // The shifters end up where they would be after the cycle 256: the last
+    // two tiles loaded, shifted 7 times since the last load. While the
+    // background is disabled they are loaded but never shifted.
+    auto GetFinalShifter = [isBackgroundEnabled](uint16_t shifter,
+                                                 const uint8_t* lastTiles) {
+        if (!isBackgroundEnabled) {
+            return static_cast<uint16_t>((shifter & 0xFF00) | lastTiles[1]);
+        }
+        return static_cast<uint16_t>(((lastTiles[0] << 8) | lastTiles[1])
+                                     << 7);
+    };
+    m_BackgroundShifter.patternLo =
+        GetFinalShifter(m_BackgroundShifter.patternLo, lastPatternLo);
+    m_BackgroundShifter.patternHi =
+        GetFinalShifter(m_BackgroundShifter.patternHi, lastPatternHi);
+    m_BackgroundShifter.attributeLo =
+        GetFinalShifter(m_BackgroundShifter.attributeLo,
+                        &attributeLo[SCANLINE_SPAN_TILES - 1]);
+    m_BackgroundShifter.attributeHi =
+        GetFinalShifter(m_BackgroundShifter.attributeHi,
+                        &attributeHi[SCANLINE_SPAN_TILES - 1]);
+
+    const bool hasSprites = areSpritesEnabled && m_SpriteCount > 0;
+    if (!m_IsRenderingEnabled && !(hasSprites && m_SpriteZeroHitPossible)) {
+        // Nothing to draw, only the sprite shifters move
+        if (hasSprites) {
+            SkipSpriteShifters();
+        }
+        m_Cycle = SCANLINE_SPAN_CYCLES + 1;
+        m_Timestamp += SCANLINE_SPAN_CYCLES;
+        return;
+    }
+    if (areSpritesEnabled && !hasSprites) {
+        m_SpriteZeroBeingRendered = false;
+    }
+    uint8_t spriteLine[256];
+    if (hasSprites) {
+        BuildSpriteLine(spriteLine);
+    }
+
+    uint16_t* line = &m_BackScreen[m_ScanLine * 256];
+    for (size_t tile = 0; tile < SCANLINE_SPAN_TILES; ++tile) {
+        // The 8 pixels of the span start fine X pixels into the tile
+        uint16_t spanPattern = 0;
+        uint8_t spanAttributeLo = 0;
+        uint8_t spanAttributeHi = 0;
+        if (isBackgroundEnabled) {
+            spanPattern = static_cast<uint16_t>(
+                ((patternRows[tile] << 16 | patternRows[tile + 1])
+                 << (m_FineX * 2)) >>
+                16);
+            auto GetSpan = [this, tile](const uint8_t* tiles) {
+                return static_cast<uint8_t>(
+                    (((tiles[tile] << 8) | tiles[tile + 1]) << m_FineX) >> 8);
+            };
+            spanAttributeLo = GetSpan(attributeLo);
+            spanAttributeHi = GetSpan(attributeHi);
+        }
+
+        for (int bit = 7; bit >= 0; --bit) {
+            const uint8_t bgPixel = (spanPattern >> (bit * 2)) & 0x03;
+            const uint8_t bgPalette = (((spanAttributeHi >> bit) & 0x01) << 1) |
+                                      ((spanAttributeLo >> bit) & 0x01);
+            const size_t x = tile * 8 + (7 - bit);
+            const uint8_t fgPixel =
+                hasSprites ? spriteLine[x] & SPRITE_LINE_PIXEL_MASK : 0;
+            if (fgPixel == 0) {
+                if (m_IsRenderingEnabled) {
+                    line[x] =
+                        m_ResolvedPalette[bgPixel == 0
+                                              ? 0
+                                              : (bgPalette << 2) | bgPixel];
+                }
+                continue;
+            }
+
+            // The sprite zero hit depends on the cycle
+            m_SpriteZeroBeingRendered =
+                (spriteLine[x] & SPRITE_LINE_SPRITE_ZERO) != 0;
+            m_Cycle = static_cast<int16_t>(x + 1);
+            auto [pixel, palette] = MixPixels(
+                bgPixel, bgPalette, fgPixel,
+                ((spriteLine[x] >> SPRITE_LINE_PALETTE_SHIFT) & 0x03) + 0x04,
+                (spriteLine[x] & SPRITE_LINE_IN_FRONT) != 0);
+            if (m_IsRenderingEnabled) {
+                line[x] = m_ResolvedPalette[(palette << 2) | pixel];
+            }
+        }
+    }
+    if (hasSprites) {
+        m_SpriteZeroBeingRendered =
+            (spriteLine[255] & SPRITE_LINE_SPRITE_ZERO) != 0;
+        SkipSpriteShifters();
+    }
+
+    m_Cycle = SCANLINE_SPAN_CYCLES + 1;
+    m_Timestamp += SCANLINE_SPAN_CYCLES;
+}
+
+uint64_t Ppu::GetNextVerticalBlankTimestamp() const {
+    return GetNextFrameTickTimestamp(VERTICAL_BLANK_START_TICK);
+}
+
+uint64_t Ppu::GetNextFrameEndTimestamp() const {
+    return GetNextFrameTickTimestamp(FRAME_END_TICK);
+}
+
+uint64_t Ppu::GetNextFrameTickTimestamp(uint32_t frameTick) const {
+    const uint32_t tick = (m_ScanLine + 1) * NUM_CYCLES + m_Cycle;
+    if (frameTick >= tick) {
+        return m_Timestamp + (frameTick - tick);
+    }
+    return m_Timestamp + (NUM_SCANLINES * NUM_CYCLES + frameTick - tick);
+}
+
+uint64_t Ppu::GetNextOamReadTimestamp() const {
+    const uint32_t tick = (m_ScanLine + 1) * NUM_CYCLES + m_Cycle;
+    uint32_t readTick = 0;
+    if (tick <= FIRST_OAM_READ_TICK) {
+        readTick = FIRST_OAM_READ_TICK;
+    } else if (tick <= LAST_OAM_READ_TICK) {
+        const int scanLine = m_Cycle <= 257 ? m_ScanLine : m_ScanLine + 1;
+        readTick = (scanLine + 1) * NUM_CYCLES + 257;
+    } else {
+        readTick = NUM_SCANLINES * NUM_CYCLES + FIRST_OAM_READ_TICK;
+    }
+    return m_Timestamp + (readTick - tick);
+}
+
 void Ppu::DoPpuActionPrerenderClear() {
     m_StatusReg.SetField(VERTICAL_BLANK, false);
 
@@ -443,8 +1059,7 @@ void Ppu::DoPpuActionPrerenderClear() {
     m_StatusReg.SetField(SPRITE_ZERO_HIT, false);
 
     for (int i = 0; i < 8; ++i) {
-        m_SpriteShifterPatternLo[i] = 0;
-        m_SpriteShifterPatternHi[i] = 0;
+        m_SpriteShifterPatterns[i] = 0;
     }
 }
 
@@ -465,36 +1080,16 @@ void Ppu::DoPpuActionRenderProcessNextTile() {
     switch ((m_Cycle - 1) % 8) {
         case 0:
             LoadBackgroundShifters();
-            m_NextBackgroundTileInfo.id =
-                PpuRead(0x2000 | (m_VramAddress.reg & 0x0FFF));
+            FetchNextTileId();
             break;
         case 2:
-            m_NextBackgroundTileInfo.attribute =
-                PpuRead(0x23C0 | (m_VramAddress.nametable_y << 11) |
-                        (m_VramAddress.nametable_x << 10) |
-                        ((m_VramAddress.coarse_y >> 2) << 3) |
-                        (m_VramAddress.coarse_x >> 2));
-            if (m_VramAddress.coarse_y & 0x02)
-                m_NextBackgroundTileInfo.attribute >>= 4;
-            if (m_VramAddress.coarse_x & 0x02)
-                m_NextBackgroundTileInfo.attribute >>= 2;
-            m_NextBackgroundTileInfo.attribute &= 0x03;
+            FetchNextTileAttribute();
             break;
         case 4:
-            m_NextBackgroundTileInfo.lsb =
-                PpuRead((m_ControlReg.GetField(
-                             ControlRegisterFields::PATTERN_BACKGROUND)
-                         << 12) +
-                        ((uint16_t)m_NextBackgroundTileInfo.id << 4) +
-                        (m_VramAddress.fine_y + 0));
+            FetchNextTilePattern(0);
             break;
         case 6:
-            m_NextBackgroundTileInfo.msb =
-                PpuRead((m_ControlReg.GetField(
-                             ControlRegisterFields::PATTERN_BACKGROUND)
-                         << 12) +
-                        ((uint16_t)m_NextBackgroundTileInfo.id << 4) +
-                        (m_VramAddress.fine_y + 8));
+            FetchNextTilePattern(1);
             break;
         case 7:
             IncrementScrollX();
@@ -527,35 +1122,76 @@ void Ppu::DoPpuActionRenderLoadShiftersAndTransferX() {
     TransferAddressX();
 }
 
-void Ppu::DoPpuActionRenderLoadNextBackgroundTile() {
-    m_NextBackgroundTileInfo.id =
-        PpuRead(0x2000 | (m_VramAddress.reg & 0x0FFF));
-}
+void Ppu::DoPpuActionRenderLoadNextBackgroundTile() { FetchNextTileId(); }
 
 void Ppu::DoPpuActionRenderDoOAMTransfer() {
-    std::memset(m_SpriteScanLine, 0xFF, 8 * sizeof(ObjectAttributeEntry));
-    m_SpriteCount = 0;
-
-    uint8_t nOAMEntry = 0;
-    m_SpriteZeroHitPossible = false;
-    while (nOAMEntry < 64 && m_SpriteCount < 9) {
-        int16_t diff = ((int16_t)m_ScanLine - (int16_t)m_OAM[nOAMEntry].y);
-        if (diff >= 0 &&
-            diff < (m_ControlReg.GetField(ControlRegisterFields::SPRITE_SIZE)
-                        ? 16
-                        : 8)) {
-            if (m_SpriteCount < 8) {
-                if (nOAMEntry == 0) {
-                    m_SpriteZeroHitPossible = true;
-                }
-                memcpy(&m_SpriteScanLine[m_SpriteCount], &m_OAM[nOAMEntry],
-                       sizeof(ObjectAttributeEntry));
-                ++m_SpriteCount;
+    const uint8_t spriteHeight =
+        m_ControlReg.GetField(ControlRegisterFields::SPRITE_SIZE) ? 16 : 8;
+    if (m_AreSpriteListsStale || spriteHeight != m_SpriteListsHeight) {
+        BuildSpriteLists(spriteHeight);
+    }
+
+    const uint8_t* sprites = m_ScanlineSprites[m_ScanLine];
+    m_SpriteCount = m_ScanlineSpriteCounts[m_ScanLine];
+    for (uint8_t i = 0; i < m_SpriteCount; ++i) {
+        m_SpriteScanLine[i] = m_OAM[sprites[i]];
+    }
+    // The unused entries are left as they would be read from an empty OAM
+    for (uint8_t i = m_SpriteCount; i < 8; ++i) {
+        m_SpriteScanLine[i] = {0xFF, 0xFF, 0xFF, 0xFF};
+    }
+    m_SpriteZeroHitPossible = m_SpriteCount > 0 && sprites[0] == 0;
+    // The sprite overflow flag is not emulated: the lists stop at 8 sprites
+    // and the flag stays as the pre-render line cleared it
+}
+
+void Ppu::BuildSpriteLists(uint8_t spriteHeight) {
+    std::memset(m_ScanlineSpriteCounts, 0, sizeof(m_ScanlineSpriteCounts));
+    for (uint8_t nOAMEntry = 0; nOAMEntry < 64; ++nOAMEntry) {
+        const int top = m_OAM[nOAMEntry].y;
+        const int bottom = std::min(top + spriteHeight, 240);
+        for (int scanLine = top; scanLine < bottom; ++scanLine) {
+            uint8_t& count = m_ScanlineSpriteCounts[scanLine];
+            if (count < 8) {
+                m_ScanlineSprites[scanLine][count++] = nOAMEntry;
             }
         }
-        ++nOAMEntry;
     }
-    m_StatusReg.SetField(SPRITE_OVERFLOW, (m_SpriteCount > 8));
+    m_SpriteListsHeight = spriteHeight;
+    m_AreSpriteListsStale = false;
+}
+
+void Ppu::BuildSpriteLine(uint8_t* spriteLine) const {
+    std::memset(spriteLine, 0, 256);
+    for (uint8_t i = 0; i < m_SpriteCount; ++i) {
+        const ObjectAttributeEntry& sprite = m_SpriteScanLine[i];
+        const uint8_t flags =
+            ((sprite.attribute & 0x03) << SPRITE_LINE_PALETTE_SHIFT) |
+            ((sprite.attribute & 0x20) ? 0 : SPRITE_LINE_IN_FRONT) |
+            (i == 0 ? SPRITE_LINE_SPRITE_ZERO : 0);
+        // The sprites are drawn from their X counter, the earlier sprites
+        // staying in front of the later ones
+        const int width = std::min(8, 256 - sprite.x);
+        for (int col = 0; col < width; ++col) {
+            const uint8_t pixel =
+                (m_SpriteShifterPatterns[i] >> (14 - col * 2)) & 0x03;
+            uint8_t& linePixel = spriteLine[sprite.x + col];
+            if (pixel != 0 && (linePixel & SPRITE_LINE_PIXEL_MASK) == 0) {
+                linePixel = flags | pixel;
+            }
+        }
+    }
+}
+
+void Ppu::SkipSpriteShifters() {
+    for (int i = 0; i < m_SpriteCount; ++i) {
+        int shifts = SCANLINE_SPAN_CYCLES - 1;
+        const int delay = std::min<int>(m_SpriteScanLine[i].x, shifts);
+        m_SpriteScanLine[i].x -= delay;
+        shifts -= delay;
+        m_SpriteShifterPatterns[i] = static_cast<uint16_t>(
+            shifts < 8 ? m_SpriteShifterPatterns[i] << (shifts * 2) : 0);
+    }
 }
 
 void Ppu::DoPpuActionRenderUpdateSprites() {
@@ -615,33 +1251,22 @@ void Ppu::DoPpuActionRenderUpdateSprites() {
             }
         }
 
-        uint16_t sprite_pattern_addr_hi = sprite_pattern_addr_lo + 8;
-
-        uint8_t sprite_pattern_bits_lo = PpuRead(sprite_pattern_addr_lo);
-        uint8_t sprite_pattern_bits_hi = PpuRead(sprite_pattern_addr_hi);
-
-        // If the sprite is flipped horizontally, we need to flip the
-        // pattern bytes.
-        if (m_SpriteScanLine[i].attribute & 0x40) {
-            // This little lambda function "flips" a byte
-            // so 0b11100000 becomes 0b00000111. It's very
-            // clever, and stolen completely from here:
-            // https://stackoverflow.com/a/2602885
-            auto flipbyte = [](uint8_t b) -> uint8_t {
-                b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
-                b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
-                b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
-                return b;
-            };
-
-            sprite_pattern_bits_lo = flipbyte(sprite_pattern_bits_lo);
-            sprite_pattern_bits_hi = flipbyte(sprite_pattern_bits_hi);
+        // The cache holds the rows flipped horizontally too
+        const bool isFlipped = m_SpriteScanLine[i].attribute & 0x40;
+        const uint8_t row = sprite_pattern_addr_lo & 0x07;
+        if (const ChrTileCache::Tile* tile =
+                m_ChrTileCache.GetTile(sprite_pattern_addr_lo)) {
+            m_SpriteShifterPatterns[i] =
+                isFlipped ? tile->m_FlippedRows[row] : tile->m_Rows[row];
+            continue;
         }
 
-        // Finally! We can load the pattern into our sprite shift
-        // registers ready for rendering on the next scanline
-        m_SpriteShifterPatternLo[i] = sprite_pattern_bits_lo;
-        m_SpriteShifterPatternHi[i] = sprite_pattern_bits_hi;
+        uint8_t sprite_pattern_bits_lo = PpuRead(sprite_pattern_addr_lo);
+        uint8_t sprite_pattern_bits_hi = PpuRead(sprite_pattern_addr_lo + 8);
+        const uint16_t pattern =
+            DecodeTileRow(sprite_pattern_bits_lo, sprite_pattern_bits_hi);
+        m_SpriteShifterPatterns[i] =
+            isFlipped ? ChrTileCache::FlipRow(pattern) : pattern;
     }
 }
 
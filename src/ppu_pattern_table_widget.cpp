@@ -4,8 +4,11 @@
 #include <fmt/core.h>
 #include <imgui.h>
 
+#include <array>
+
 #include "dear_nes_lib/nes.h"
 #include "dear_nes_lib/ppu.h"
+#include "dear_nes_lib/tile_decoder.h"
 #include "include/dearnes_base_widget.h"
 
 PpuPatternTableWidget::PpuPatternTableWidget(dearnes::Nes* nesPtr, unsigned int patternTableIdx)
@@ -34,31 +37,33 @@ void PpuPatternTableWidget::Render() {
 void PpuPatternTableWidget::Update(float /*delta*/) {
     if (m_Show) {
         UpdatePatternTable();
-        m_PpuPatternTable.Update();
+        m_PpuPatternTable.UpdateFromArray(m_Pixels.data());
     }
 }
 
 void PpuPatternTableWidget::UpdatePatternTable() {
     auto ppuPtr = m_NesPtr->GetPpu();
-    for (uint16_t nTileX = 0; nTileX < 16; ++nTileX) {
-        for (uint16_t nTileY = 0; nTileY < 16; ++nTileY) {
-            uint16_t offset = nTileY * 256 + nTileX * 16;
+    std::array<uint8_t, NUM_TILES * dearnes::SIZE_TILE> tiles;
+    for (uint16_t offset = 0; offset < tiles.size(); ++offset) {
+        tiles[offset] = ppuPtr->PpuRead(m_PatternTableIdx * 0x1000 + offset);
+    }
+    std::array<uint16_t, NUM_TILES * 8> rows;
+    dearnes::DecodeTiles(tiles.data(), NUM_TILES, rows.data());
 
-            for (uint16_t row = 0; row < 8; ++row) {
-                uint8_t tileLSB = ppuPtr->PpuRead(m_PatternTableIdx * 0x1000 +
-                                                    offset + row + 0);
-                uint8_t tileMSB = ppuPtr->PpuRead(m_PatternTableIdx * 0x1000 +
-                                                    offset + row + 8);
-                for (uint16_t col = 0; col < 8; ++col) {
-                    uint8_t pixel = static_cast<uint8_t>(tileLSB & 0b01) +
-                                    static_cast<uint8_t>((tileMSB << 1) & 0b10);
-                    tileLSB >>= 1;
-                    tileMSB >>= 1;
+    int colors[4];
+    for (uint8_t pixel = 0; pixel < 4; ++pixel) {
+        colors[pixel] = ppuPtr->GetColorFromPalette(DEFAULT_PALETTE, pixel);
+    }
 
-                    m_PpuPatternTable.SetPixel(
-                        nTileX * 8 + (7 - col), nTileY * 8 + row,
-                        ppuPtr->GetColorFromPalette(DEFAULT_PALETTE, pixel));
-                }
+    // The tiles are laid out in 16 rows of 16
+    for (size_t tile = 0; tile < NUM_TILES; ++tile) {
+        for (size_t row = 0; row < 8; ++row) {
+            const uint16_t pixels = rows[tile * 8 + row];
+            int* destination =
+                &m_Pixels[((tile / 16) * 8 + row) * PATTERN_TABLE_REAL_WIDTH +
+                          (tile % 16) * 8];
+            for (size_t col = 0; col < 8; ++col) {
+                destination[col] = colors[(pixels >> (14 - col * 2)) & 0x03];
             }
         }
     }
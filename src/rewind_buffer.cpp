@@ -0,0 +1,155 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/rewind_buffer.h"
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "dear_nes_lib/nes.h"
+#include "dear_nes_lib/state_delta.h"
+
+namespace dearnes {
+
+RewindBuffer::RewindBuffer(size_t memoryBudget, uint32_t keyframeInterval)
+    : m_Storage(memoryBudget),
+      m_KeyframeInterval{keyframeInterval > 0 ? keyframeInterval : 1} {}
+
+bool RewindBuffer::Push(const Nes& nes) {
+    const size_t stateSize = nes.GetStateSize();
+    if (stateSize != m_LastState.size()) {
+        // New cartridge, or the cartridge made a copy of its ROM: the
+        // history can not be stored as deltas with the new states
+        Clear();
+        m_LastState.resize(stateSize);
+        m_NewState.resize(stateSize);
+        m_Delta.resize(GetMaxStateDeltaSize(stateSize));
+    }
+    nes.SaveState(m_NewState.data(), stateSize);
+
+    bool isKeyframe = m_Records.empty() ||
+                      m_FramesSinceKeyframe + 1 >= m_KeyframeInterval;
+    const uint8_t* data = m_NewState.data();
+    size_t size = stateSize;
+    if (!isKeyframe) {
+        const size_t deltaSize = EncodeStateDelta(
+            m_NewState.data(), m_LastState.data(), stateSize, m_Delta.data());
+        if (deltaSize < stateSize) {
+            data = m_Delta.data();
+            size = deltaSize;
+        } else {
+            isKeyframe = true;
+        }
+    }
+
+    size_t offset = 0;
+    if (!Allocate(size, offset)) {
+        Clear();
+        return false;
+    }
+    if (!isKeyframe && m_Records.empty()) {
+        // Making room dropped the keyframe this delta is based on
+        isKeyframe = true;
+        data = m_NewState.data();
+        size = stateSize;
+        if (!Allocate(size, offset)) {
+            return false;
+        }
+    }
+
+    std::memcpy(&m_Storage[offset], data, size);
+    m_Records.push_back({offset, size, isKeyframe});
+    m_Head = offset + size;
+    m_UsedBytes += size;
+    m_FramesSinceKeyframe = isKeyframe ? 0 : m_FramesSinceKeyframe + 1;
+    std::swap(m_LastState, m_NewState);
+    return true;
+}
+
+bool RewindBuffer::Rewind(Nes& nes) {
+    if (m_Records.empty()) {
+        return false;
+    }
+    if (!nes.LoadState(m_LastState.data(), m_LastState.size())) {
+        Clear();
+        return false;
+    }
+
+    const Record record = m_Records.back();
+    m_Records.pop_back();
+    m_UsedBytes -= record.m_Size;
+    m_Head = record.m_Offset;
+
+    if (m_Records.empty()) {
+        m_FramesSinceKeyframe = 0;
+    } else if (record.m_IsKeyframe) {
+        RebuildLastState();
+    } else {
+        ApplyStateDelta(&m_Storage[record.m_Offset], record.m_Size,
+                        m_LastState.data());
+        --m_FramesSinceKeyframe;
+    }
+    return true;
+}
+
+void RewindBuffer::Clear() {
+    m_Records.clear();
+    m_Head = 0;
+    m_UsedBytes = 0;
+    m_FramesSinceKeyframe = 0;
+}
+
+bool RewindBuffer::Allocate(size_t size, size_t& offset) {
+    if (size > m_Storage.size()) {
+        return false;
+    }
+    if (m_Head + size > m_Storage.size()) {
+        // The records between the head and the end of the buffer are the
+        // oldest ones. Drop them and wrap around.
+        while (!m_Records.empty() && m_Records.front().m_Offset >= m_Head) {
+            DropOldestRecord();
+        }
+        m_Head = 0;
+    }
+    auto Overlaps = [&](const Record& record) {
+        return record.m_Offset < m_Head + size &&
+               m_Head < record.m_Offset + record.m_Size;
+    };
+    while (!m_Records.empty() && Overlaps(m_Records.front())) {
+        DropOldestRecord();
+    }
+    offset = m_Head;
+    return true;
+}
+
+void RewindBuffer::DropOldestRecord() {
+    const bool wasKeyframe = m_Records.front().m_IsKeyframe;
+    m_UsedBytes -= m_Records.front().m_Size;
+    m_Records.pop_front();
+    while (wasKeyframe && !m_Records.empty() &&
+           !m_Records.front().m_IsKeyframe) {
+        m_UsedBytes -= m_Records.front().m_Size;
+        m_Records.pop_front();
+    }
+}
+
+void RewindBuffer::RebuildLastState() {
+    // Whole groups are dropped, so the oldest record is always a keyframe
+    size_t keyframeIdx = m_Records.size() - 1;
+    while (!m_Records[keyframeIdx].m_IsKeyframe) {
+        assert(keyframeIdx > 0);
+        --keyframeIdx;
+    }
+
+    const Record& keyframe = m_Records[keyframeIdx];
+    assert(keyframe.m_Size == m_LastState.size());
+    std::memcpy(m_LastState.data(), &m_Storage[keyframe.m_Offset],
+                keyframe.m_Size);
+    for (size_t i = keyframeIdx + 1; i < m_Records.size(); ++i) {
+        ApplyStateDelta(&m_Storage[m_Records[i].m_Offset],
+                        m_Records[i].m_Size, m_LastState.data());
+    }
+    m_FramesSinceKeyframe =
+        static_cast<uint32_t>(m_Records.size() - 1 - keyframeIdx);
+}
+
+}  // namespace dearnes
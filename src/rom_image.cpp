@@ -0,0 +1,46 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/rom_image.h"
+
+#include <utility>
+
+namespace dearnes {
+
+RomImage::RomImage(CartridgeHeader&& header,
+                   std::vector<uint8_t>&& programMemory,
+                   std::vector<uint8_t>&& characterMemory)
+    : m_Header{std::move(header)},
+      m_ProgramMemoryBuffer{std::move(programMemory)},
+      m_CharacterMemoryBuffer{std::move(characterMemory)},
+      m_ProgramMemory{m_ProgramMemoryBuffer.data()},
+      m_ProgramMemorySize{m_ProgramMemoryBuffer.size()},
+      m_CharacterMemory{m_CharacterMemoryBuffer.data()},
+      m_CharacterMemorySize{m_CharacterMemoryBuffer.size()} {}
+
+RomImage::RomImage(CartridgeHeader&& header,
+                   std::unique_ptr<MappedFile> mappedFile,
+                   size_t programMemoryOffset, size_t programMemorySize,
+                   size_t characterMemoryOffset, size_t characterMemorySize)
+    : m_Header{std::move(header)},
+      m_MappedFile{std::move(mappedFile)},
+      m_ProgramMemory{m_MappedFile->GetData() + programMemoryOffset},
+      m_ProgramMemorySize{programMemorySize},
+      m_CharacterMemory{m_MappedFile->GetData() + characterMemoryOffset},
+      m_CharacterMemorySize{characterMemorySize} {}
+
+uint64_t RomImage::GetHash() const {
+    std::call_once(m_HashOnce, [this] { ComputeHash(); });
+    return m_Hash;
+}
+
+void RomImage::ComputeHash() const {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (size_t i = 0; i < m_ProgramMemorySize; ++i) {
+        hash = (hash ^ m_ProgramMemory[i]) * 0x100000001B3;
+    }
+    for (size_t i = 0; i < m_CharacterMemorySize; ++i) {
+        hash = (hash ^ m_CharacterMemory[i]) * 0x100000001B3;
+    }
+    m_Hash = hash;
+}
+
+}  // namespace dearnes
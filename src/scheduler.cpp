@@ -0,0 +1,92 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/scheduler.h"
+
+#include <cassert>
+
+namespace dearnes {
+
+Scheduler::Scheduler() { Clear(); }
+
+void Scheduler::Schedule(ScheduledEvent event, uint64_t timestamp) {
+    const size_t eventIdx = static_cast<size_t>(event);
+    size_t position = m_Positions[eventIdx];
+    if (position == NOT_SCHEDULED) {
+        position = m_Size++;
+    }
+    Place(position, {timestamp, event});
+    SiftUp(position);
+    SiftDown(m_Positions[eventIdx]);
+}
+
+void Scheduler::Cancel(ScheduledEvent event) {
+    const uint8_t position = m_Positions[static_cast<size_t>(event)];
+    if (position != NOT_SCHEDULED) {
+        Remove(position);
+    }
+}
+
+void Scheduler::Clear() {
+    m_Size = 0;
+    m_Positions.fill(NOT_SCHEDULED);
+}
+
+ScheduledEvent Scheduler::PopNextEvent() {
+    assert(m_Size > 0);
+    const ScheduledEvent event = m_Heap[0].m_Event;
+    Remove(0);
+    return event;
+}
+
+void Scheduler::SiftUp(size_t position) {
+    const Entry entry = m_Heap[position];
+    while (position > 0) {
+        const size_t parent = (position - 1) / 2;
+        if (m_Heap[parent].m_Timestamp <= entry.m_Timestamp) {
+            break;
+        }
+        Place(position, m_Heap[parent]);
+        position = parent;
+    }
+    Place(position, entry);
+}
+
+void Scheduler::SiftDown(size_t position) {
+    const Entry entry = m_Heap[position];
+    while (true) {
+        size_t child = position * 2 + 1;
+        if (child >= m_Size) {
+            break;
+        }
+        if (child + 1 < m_Size &&
+            m_Heap[child + 1].m_Timestamp < m_Heap[child].m_Timestamp) {
+            ++child;
+        }
+        if (entry.m_Timestamp <= m_Heap[child].m_Timestamp) {
+            break;
+        }
+        Place(position, m_Heap[child]);
+        position = child;
+    }
+    Place(position, entry);
+}
+
+void Scheduler::Remove(size_t position) {
+    m_Positions[static_cast<size_t>(m_Heap[position].m_Event)] = NOT_SCHEDULED;
+    --m_Size;
+    if (position == m_Size) {
+        return;
+    }
+    // The last entry fills the hole, and moves up or down from there
+    const size_t movedIdx = static_cast<size_t>(m_Heap[m_Size].m_Event);
+    Place(position, m_Heap[m_Size]);
+    SiftUp(position);
+    SiftDown(m_Positions[movedIdx]);
+}
+
+void Scheduler::Place(size_t position, const Entry& entry) {
+    m_Heap[position] = entry;
+    m_Positions[static_cast<size_t>(entry.m_Event)] =
+        static_cast<uint8_t>(position);
+}
+
+}  // namespace dearnes
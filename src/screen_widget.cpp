@@ -2,11 +2,12 @@
 #include "include/screen_widget.h"
 #include <imgui.h>
 
-#include "dear_nes_lib/nes.h"
-#include "dear_nes_lib/ppu.h"
+#include "dear_nes_lib/emulation_thread.h"
 #include "include/dearnes_base_widget.h"
 
-ScreenWidget::ScreenWidget(dearnes::Nes* nesPtr) : DearNESBaseWidget(nesPtr) {}
+ScreenWidget::ScreenWidget(dearnes::Nes* nesPtr,
+                           dearnes::EmulationThread* emulationThreadPtr)
+    : DearNESBaseWidget(nesPtr), m_EmulationThreadPtr{emulationThreadPtr} {}
 
 void ScreenWidget::Render() {
     if (!m_Show) {
@@ -27,9 +28,13 @@ void ScreenWidget::Render() {
 }
 
 void ScreenWidget::Update(float delta) {
-    if (m_Show) {
-        m_NesScreenTextureImage.CopyTextureFromArray(
-            m_NesPtr->GetPpu()->GetOutputScreen());
-        m_NesScreenTextureImage.Update();
+    // Only the newest frame published by the emulation thread is uploaded,
+    // and only when there is a new one. It stays valid until the next
+    // acquire.
+    if (!m_Show) {
+        return;
+    }
+    if (const int* frame = m_EmulationThreadPtr->AcquireFrame()) {
+        m_NesScreenTextureImage.UpdateFromArray(frame);
     }
 }
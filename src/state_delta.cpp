@@ -0,0 +1,139 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/state_delta.h"
+
+#include <cstring>
+
+namespace dearnes {
+
+namespace {
+
+inline uint64_t Load64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/// <summary>
+/// True if the bytes from offset on are the same in both states. Whole words
+/// are compared where possible, so that a run of changed bytes only ends
+/// before at least 8 unchanged bytes.
+/// </summary>
+inline bool IsUnchanged(const uint8_t* state, const uint8_t* previous,
+                        size_t offset, size_t size) {
+    if (offset + sizeof(uint64_t) <= size) {
+        return Load64(state + offset) == Load64(previous + offset);
+    }
+    return state[offset] == previous[offset];
+}
+
+inline size_t WriteVarint(size_t value, uint8_t* out) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+inline size_t ReadVarint(const uint8_t* in, size_t& offset) {
+    size_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        const uint8_t byte = in[offset++];
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+/// <summary>
+/// ReadVarint for untrusted data, false if it goes past the end
+/// </summary>
+inline bool ReadVarintChecked(const uint8_t* in, size_t size, size_t& offset,
+                              size_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (offset >= size) {
+            return false;
+        }
+        const uint8_t byte = in[offset++];
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+size_t EncodeStateDelta(const uint8_t* state, const uint8_t* previous,
+                        size_t size, uint8_t* delta) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < size) {
+        const size_t unchangedStart = in;
+        while (in + sizeof(uint64_t) <= size &&
+               Load64(state + in) == Load64(previous + in)) {
+            in += sizeof(uint64_t);
+        }
+        while (in < size && state[in] == previous[in]) {
+            ++in;
+        }
+        const size_t unchanged = in - unchangedStart;
+
+        const size_t changedStart = in;
+        while (in < size && !IsUnchanged(state, previous, in, size)) {
+            ++in;
+        }
+        const size_t changed = in - changedStart;
+        if (changed == 0) {
+            // Only unchanged bytes left
+            break;
+        }
+
+        out += WriteVarint(unchanged, delta + out);
+        out += WriteVarint(changed, delta + out);
+        for (size_t i = changedStart; i < in; ++i) {
+            delta[out++] = state[i] ^ previous[i];
+        }
+    }
+    return out;
+}
+
+void ApplyStateDelta(const uint8_t* delta, size_t deltaSize, uint8_t* state) {
+    size_t in = 0;
+    size_t offset = 0;
+    while (in < deltaSize) {
+        offset += ReadVarint(delta, in);
+        const size_t changed = ReadVarint(delta, in);
+        for (size_t i = 0; i < changed; ++i) {
+            state[offset + i] ^= delta[in + i];
+        }
+        in += changed;
+        offset += changed;
+    }
+}
+
+bool IsValidStateDelta(const uint8_t* delta, size_t deltaSize,
+                       size_t stateSize) {
+    size_t in = 0;
+    size_t offset = 0;
+    while (in < deltaSize) {
+        size_t unchanged = 0;
+        size_t changed = 0;
+        if (!ReadVarintChecked(delta, deltaSize, in, unchanged) ||
+            !ReadVarintChecked(delta, deltaSize, in, changed) ||
+            unchanged > stateSize - offset ||
+            changed > stateSize - offset - unchanged ||
+            changed > deltaSize - in) {
+            return false;
+        }
+        in += changed;
+        offset += unchanged + changed;
+    }
+    return true;
+}
+
+}  // namespace dearnes
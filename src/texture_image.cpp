@@ -68,6 +68,12 @@ void ImGuiTextureImage::CopyTextureFromArray(const int* intArray) {
            m_Width * m_Height * sizeof(int));
 }
 
+void ImGuiTextureImage::UpdateFromArray(const int* intArray) {
+    glBindTexture(GL_TEXTURE_2D, m_textureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, PIXEL_FORMAT,
+                    GL_UNSIGNED_BYTE, (const GLvoid*)intArray);
+}
+
 void ImGuiTextureImage::ScaleImageToWidth(float newWidth) {
     if (newWidth == m_TextureWidth) {
         return;
@@ -0,0 +1,135 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "dear_nes_lib/tile_decoder.h"
+
+// Microbenchmark of the tile decoding kernels. A whole pattern table is
+// decoded with each kernel, and with the bit by bit loop they replace.
+
+using dearnes::TileDecoderKernel;
+
+namespace {
+
+constexpr size_t PATTERN_TABLE_TILES = 256;
+
+// Each measurement is repeated, and the fastest run is kept to filter out the
+// noise from the rest of the system
+constexpr int REPETITIONS = 9;
+
+constexpr TileDecoderKernel KERNELS[] = {
+    TileDecoderKernel::LUT,
+    TileDecoderKernel::SSE2,
+    TileDecoderKernel::AVX2,
+};
+
+/// <summary>
+/// Reference decoding, one pixel at a time
+/// </summary>
+void DecodeTilesBitByBit(const uint8_t* tiles, size_t tileCount,
+                         uint16_t* rows) {
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        for (size_t row = 0; row < 8; ++row) {
+            uint8_t lo = tiles[tile * dearnes::SIZE_TILE + row];
+            uint8_t hi = tiles[tile * dearnes::SIZE_TILE + row + 8];
+            uint16_t pixels = 0;
+            for (size_t col = 0; col < 8; ++col) {
+                const uint16_t pixel = (lo & 0x01) | ((hi << 1) & 0x02);
+                pixels |= pixel << (col * 2);
+                lo >>= 1;
+                hi >>= 1;
+            }
+            rows[tile * 8 + row] = pixels;
+        }
+    }
+}
+
+/// <summary>
+/// Returns the average time to decode a pattern table, in nanoseconds
+/// </summary>
+template <typename DecodeFunction>
+double Benchmark(DecodeFunction decode, const std::vector<uint8_t>& tiles,
+                 std::vector<uint16_t>& rows, uint64_t iterations) {
+    double bestTime = HUGE_VAL;
+    for (int i = 0; i < REPETITIONS; ++i) {
+        const auto startTime = std::chrono::steady_clock::now();
+        for (uint64_t j = 0; j < iterations; ++j) {
+            decode(&tiles[(j % 2) * PATTERN_TABLE_TILES * dearnes::SIZE_TILE],
+                   PATTERN_TABLE_TILES, rows.data());
+        }
+        const auto endTime = std::chrono::steady_clock::now();
+        bestTime = std::fmin(
+            bestTime,
+            std::chrono::duration<double, std::nano>(endTime - startTime)
+                    .count() /
+                iterations);
+    }
+    return bestTime;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = 10000;
+    if (argc > 1) {
+        iterations = std::strtoull(argv[1], nullptr, 10);
+    }
+    if (iterations == 0) {
+        fmt::print("Usage: dear_nes_tile_bench [pattern tables per run]\n");
+        return 1;
+    }
+
+    // Both pattern tables, decoded in turns
+    std::vector<uint8_t> tiles(2 * PATTERN_TABLE_TILES * dearnes::SIZE_TILE);
+    std::mt19937 random{1234};
+    for (uint8_t& byte : tiles) {
+        byte = static_cast<uint8_t>(random());
+    }
+
+    const size_t rowCount = 2 * PATTERN_TABLE_TILES * 8;
+    std::vector<uint16_t> expectedRows(rowCount);
+    DecodeTilesBitByBit(tiles.data(), 2 * PATTERN_TABLE_TILES,
+                        expectedRows.data());
+
+    std::vector<uint16_t> rows(rowCount);
+    const double referenceTime =
+        Benchmark(&DecodeTilesBitByBit, tiles, rows, iterations);
+
+    fmt::print("{:<12} {:>14} {:>8}\n", "Kernel", "4 KB table us", "Speedup");
+    fmt::print("{:<12} {:>14.3f} {:>7.2f}x\n", "Bit by bit",
+               referenceTime / 1000.0, 1.0);
+    for (TileDecoderKernel kernel : KERNELS) {
+        const char* name = dearnes::GetTileDecoderKernelName(kernel);
+        if (!dearnes::IsTileDecoderKernelSupported(kernel)) {
+            fmt::print("{:<12} {:>14}\n", name, "unsupported");
+            continue;
+        }
+
+        std::vector<uint16_t> decodedRows(rowCount);
+        dearnes::DecodeTiles(kernel, tiles.data(), 2 * PATTERN_TABLE_TILES,
+                             decodedRows.data());
+        if (decodedRows != expectedRows) {
+            fmt::print("{:<12} decodes wrong pixels\n", name);
+            return 1;
+        }
+
+        auto decode = [kernel](const uint8_t* tilesToDecode, size_t tileCount,
+                               uint16_t* decoded) {
+            dearnes::DecodeTiles(kernel, tilesToDecode, tileCount, decoded);
+        };
+        const double time = Benchmark(decode, tiles, rows, iterations);
+        fmt::print("{:<12} {:>14.3f} {:>7.2f}x\n", name, time / 1000.0,
+                   referenceTime / time);
+    }
+
+    fmt::print("\nKernel used by the emulator: {}\n",
+               dearnes::GetTileDecoderKernelName(
+                   dearnes::GetBestTileDecoderKernel()));
+    return 0;
+}
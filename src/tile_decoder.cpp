@@ -0,0 +1,192 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/tile_decoder.h"
+
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DEARNES_TILE_DECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define DEARNES_TILE_DECODER_AVX2
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define DEARNES_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#include <intrin.h>
+#define DEARNES_TARGET_AVX2
+#endif
+#endif
+
+namespace dearnes {
+
+namespace {
+
+void DecodeTilesLut(const uint8_t* tiles, size_t tileCount, uint16_t* rows) {
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        const uint8_t* planes = &tiles[tile * SIZE_TILE];
+        for (size_t row = 0; row < 8; ++row) {
+            rows[tile * 8 + row] = DecodeTileRow(planes[row], planes[row + 8]);
+        }
+    }
+}
+
+// The SIMD kernels put the two bitplanes of a row in the same 16 bit lane,
+// bit 1 in the high byte, and interleave the two bytes with the perfect
+// shuffle of Hacker's Delight (7-2): each step swaps the middle two of four
+// groups of bits.
+
+#ifdef DEARNES_TILE_DECODER_SSE2
+inline __m128i SwapBitGroups(__m128i lanes, int shift, uint16_t mask) {
+    const __m128i swapped =
+        _mm_and_si128(_mm_xor_si128(lanes, _mm_srli_epi16(lanes, shift)),
+                      _mm_set1_epi16(static_cast<short>(mask)));
+    return _mm_xor_si128(
+        lanes, _mm_xor_si128(swapped, _mm_slli_epi16(swapped, shift)));
+}
+
+void DecodeTilesSse2(const uint8_t* tiles, size_t tileCount, uint16_t* rows) {
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        const __m128i planes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(&tiles[tile * SIZE_TILE]));
+        __m128i lanes = _mm_unpacklo_epi8(planes, _mm_srli_si128(planes, 8));
+        lanes = SwapBitGroups(lanes, 4, 0x00F0);
+        lanes = SwapBitGroups(lanes, 2, 0x0C0C);
+        lanes = SwapBitGroups(lanes, 1, 0x2222);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&rows[tile * 8]), lanes);
+    }
+}
+#endif
+
+#ifdef DEARNES_TILE_DECODER_AVX2
+DEARNES_TARGET_AVX2 inline __m256i SwapBitGroups256(__m256i lanes, int shift,
+                                                    uint16_t mask) {
+    const __m256i swapped = _mm256_and_si256(
+        _mm256_xor_si256(lanes, _mm256_srli_epi16(lanes, shift)),
+        _mm256_set1_epi16(static_cast<short>(mask)));
+    return _mm256_xor_si256(
+        lanes, _mm256_xor_si256(swapped, _mm256_slli_epi16(swapped, shift)));
+}
+
+// Two tiles at a time, one per 128 bit half
+DEARNES_TARGET_AVX2 void DecodeTilesAvx2(const uint8_t* tiles,
+                                         size_t tileCount, uint16_t* rows) {
+    size_t tile = 0;
+    for (; tile + 2 <= tileCount; tile += 2) {
+        const __m256i planes = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(&tiles[tile * SIZE_TILE]));
+        __m256i lanes =
+            _mm256_unpacklo_epi8(planes, _mm256_srli_si256(planes, 8));
+        lanes = SwapBitGroups256(lanes, 4, 0x00F0);
+        lanes = SwapBitGroups256(lanes, 2, 0x0C0C);
+        lanes = SwapBitGroups256(lanes, 1, 0x2222);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&rows[tile * 8]),
+                            lanes);
+    }
+    DecodeTilesLut(&tiles[tile * SIZE_TILE], tileCount - tile, &rows[tile * 8]);
+}
+
+bool IsAvx2Supported() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    // AVX2 needs the CPU support, and the OS saving the YMM registers
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    constexpr int osxsaveBit = 1 << 27;
+    constexpr int avxBit = 1 << 28;
+    if ((info[2] & (osxsaveBit | avxBit)) != (osxsaveBit | avxBit) ||
+        (_xgetbv(0) & 0x06) != 0x06) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    constexpr int avx2Bit = 1 << 5;
+    return (info[1] & avx2Bit) != 0;
+#endif
+}
+#endif
+
+using DecodeTilesFunction = void (*)(const uint8_t*, size_t, uint16_t*);
+
+DecodeTilesFunction GetDecodeTilesFunction(TileDecoderKernel kernel) {
+    switch (kernel) {
+#ifdef DEARNES_TILE_DECODER_SSE2
+        case TileDecoderKernel::SSE2:
+            return &DecodeTilesSse2;
+#endif
+#ifdef DEARNES_TILE_DECODER_AVX2
+        case TileDecoderKernel::AVX2:
+            return &DecodeTilesAvx2;
+#endif
+        default:
+            return &DecodeTilesLut;
+    }
+}
+
+}  // namespace
+
+void DecodeTiles(const uint8_t* tiles, size_t tileCount, uint16_t* rows) {
+    static const DecodeTilesFunction decodeTiles =
+        GetDecodeTilesFunction(GetBestTileDecoderKernel());
+    decodeTiles(tiles, tileCount, rows);
+}
+
+void DecodeTiles(TileDecoderKernel kernel, const uint8_t* tiles,
+                 size_t tileCount, uint16_t* rows) {
+    assert(IsTileDecoderKernelSupported(kernel));
+    GetDecodeTilesFunction(kernel)(tiles, tileCount, rows);
+}
+
+bool IsTileDecoderKernelSupported(TileDecoderKernel kernel) {
+    switch (kernel) {
+        case TileDecoderKernel::LUT:
+            return true;
+        case TileDecoderKernel::SSE2:
+#ifdef DEARNES_TILE_DECODER_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case TileDecoderKernel::AVX2:
+#ifdef DEARNES_TILE_DECODER_AVX2
+            return IsAvx2Supported();
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+TileDecoderKernel GetBestTileDecoderKernel() {
+    static const TileDecoderKernel bestKernel = [] {
+        for (TileDecoderKernel kernel :
+             {TileDecoderKernel::AVX2, TileDecoderKernel::SSE2}) {
+            if (IsTileDecoderKernelSupported(kernel)) {
+                return kernel;
+            }
+        }
+        return TileDecoderKernel::LUT;
+    }();
+    return bestKernel;
+}
+
+const char* GetTileDecoderKernelName(TileDecoderKernel kernel) {
+    switch (kernel) {
+        case TileDecoderKernel::LUT:
+            return "LUT";
+        case TileDecoderKernel::SSE2:
+            return "SSE2";
+        case TileDecoderKernel::AVX2:
+            return "AVX2";
+    }
+    return "";
+}
+
+}  // namespace dearnes
@@ -0,0 +1,116 @@
+// Copyright (c) 2026 Emmanuel Arias
+#include "dear_nes_lib/work_stealing_pool.h"
+
+#include <cassert>
+
+namespace dearnes {
+
+namespace {
+// Identifies the pool and the queue of the current thread, if it is a worker
+thread_local const WorkStealingPool* t_WorkerPool = nullptr;
+thread_local size_t t_WorkerIdx = 0;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(size_t numThreads) {
+    assert(numThreads > 0);
+    for (size_t i = 0; i < numThreads; ++i) {
+        m_Queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        m_Threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock{m_StateMutex};
+        m_Stop = true;
+    }
+    m_TaskAvailable.notify_all();
+    for (std::thread& thread : m_Threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    const size_t queueIdx =
+        t_WorkerPool == this
+            ? t_WorkerIdx
+            : m_NextQueue.fetch_add(1, std::memory_order_relaxed) %
+                  m_Queues.size();
+
+    m_PendingTasks.fetch_add(1);
+    // Counted before the task is published, so that a worker taking it right
+    // away never brings the counter below zero
+    m_QueuedTasks.fetch_add(1);
+    {
+        WorkerQueue& queue = *m_Queues[queueIdx];
+        std::lock_guard<std::mutex> lock{queue.m_Mutex};
+        queue.m_Tasks.push_back(std::move(task));
+    }
+    {
+        // A worker about to wait checks the counter with the lock held, so
+        // it either sees the task or gets the notification
+        std::lock_guard<std::mutex> lock{m_StateMutex};
+    }
+    m_TaskAvailable.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    assert(t_WorkerPool != this);
+    std::unique_lock<std::mutex> lock{m_StateMutex};
+    m_AllTasksDone.wait(lock, [this] { return m_PendingTasks.load() == 0; });
+}
+
+bool WorkStealingPool::PopLocalTask(size_t workerIdx, Task& task) {
+    WorkerQueue& queue = *m_Queues[workerIdx];
+    std::lock_guard<std::mutex> lock{queue.m_Mutex};
+    if (queue.m_Tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.m_Tasks.back());
+    queue.m_Tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::StealTask(size_t workerIdx, Task& task) {
+    for (size_t i = 1; i < m_Queues.size(); ++i) {
+        WorkerQueue& queue = *m_Queues[(workerIdx + i) % m_Queues.size()];
+        std::lock_guard<std::mutex> lock{queue.m_Mutex};
+        if (!queue.m_Tasks.empty()) {
+            task = std::move(queue.m_Tasks.front());
+            queue.m_Tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::WorkerLoop(size_t workerIdx) {
+    t_WorkerPool = this;
+    t_WorkerIdx = workerIdx;
+
+    Task task;
+    while (true) {
+        if (PopLocalTask(workerIdx, task) || StealTask(workerIdx, task)) {
+            m_QueuedTasks.fetch_sub(1);
+            task();
+            task = nullptr;
+            if (m_PendingTasks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock{m_StateMutex};
+                m_AllTasksDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{m_StateMutex};
+        m_TaskAvailable.wait(
+            lock, [this] { return m_Stop || m_QueuedTasks.load() > 0; });
+        if (m_Stop && m_QueuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+}  // namespace dearnes